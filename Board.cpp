@@ -21,12 +21,6 @@ static const char esc = '';
 static const std::string reset = "[0m";
 
 
-/**
- * 8 directions  (vectors) on the board.
- * 
- */
-static constexpr int direction[8][2] = {{0,-1},{1,-1},{1,0},{1,1},{0,1},{-1,1},{-1,0},{-1,-1}};
-
 /**
  * Controls the size of the printed board.
  * 
@@ -36,36 +30,6 @@ bool Board::print_size_big = true;
 bool Board::clear_screen_before_printing = false;
 
 
-/** 
- * Checks if coordinates are in range.  It works with a signed type as
- * in calculations we may produce invalid coordinates by
- * icrement/decrement, etc.
- * 
- * @param x 
- * @param y 
- * 
- * @return 
- */
-bool Board::validCoords(int8_t x, int8_t y) const {
-  return ( x >= 0 ) && ( x < w() ) && ( y >= 0 ) && ( y < h() );
-}
-
-
-/** 
- * Set tile at (x,y) to a particular color
- * 
- * @param x 
- * @param y 
- * @param player
- */
-void Board::setColor(uint8_t x, uint8_t y, Player player) {
-  if(player == WHITE ) {
-    setWhite(x,y);
-  } else {
-    setBlack(x,y);
-  }
-}
-
 /** 
  * Constructs default board 
  */
@@ -87,63 +51,6 @@ Board::Board() :
   setBlack(half_width-1, half_height - 1);  
 }
 
-/** 
- * For a given board square and each of the 8 rays from that square
- * compute number of tiles to flip along that ray. As a side
- * efect, determine whether whe move is legal, in the sense that
- * it would result in flipping some tiles to the player's color.
- * The value returned is true if the move is legal.
- *
- * If shortCircuit is true, however, the calculation
- * is abandoned upon discovering that squares will be flipped
- * and true is returned immediately. In this case, the
- * values in flipRadius array may not valid except for one.
- * 
- * @param player
- * @param x 
- * @param y 
- * @param flipRadius
- * @param shortCircuit
- * 
- * @return True if the move is legal
- */
-bool Board::findFlipRadius(Player player, uint8_t x, uint8_t y,
-			   uint8_t flipRadius[8],
-			   bool shortCircuit) const
-{
-  assert(!isFilled(x, y));
-
-  bool legal = false;
-  for (int ray = 0; ray < 8; ++ray) { //iter over cardinal + diagonals
-    int8_t end = 0;
-    uint8_t distance = 1;
-    for(/* Empty */; end == 0; ++distance) {
-      int8_t tmpx = x + distance * direction[ray][0];
-      int8_t tmpy = y + distance * direction[ray][1];
-
-      if ( !validCoords(tmpx, tmpy) ) {
-	end = 1;		//ran off edge
-      } else if( !isFilled(tmpx,tmpy) ) {
-	end = 2;		//ran into an empty space
-      } else if( isWhite(tmpx, tmpy) == (player == WHITE) ) {
-	end = ( distance > 1 ) ? 3 : 4; //ran into own color late vs early
-      }
-    }
-    if (end == 3) {
-      flipRadius[ray] = distance;
-      legal = true;
-      if(shortCircuit) {
-	// We determined that move is legal
-	// and abandon further calculatons
-	break;
-      }
-    } else {
-      flipRadius[ray] = 0;
-    }
-  } 
-  return legal;
-}
-
 /** 
  * Generate all moves.
  * 
@@ -151,30 +58,17 @@ bool Board::findFlipRadius(Player player, uint8_t x, uint8_t y,
  * 
  * @return A list of triples (x, y, board) such
  *         that board is the board after a valid move (x, y)
- *         is made.
- *
- * @throw std::bad_alloc
+ *         is made, in the order of square index.
  */
 Board::move_bag_type
 Board::moves(Player player) const
 {
   move_bag_type move_bag;
-  for( auto x = 0; x < w(); ++x) {
-    for( auto y = 0; y < h(); ++y) {
-      if( isFilled(x,y) ) continue;
-      uint8_t flipRadius[8];
-      auto legal = findFlipRadius(player, x, y, flipRadius);
-      if (legal) {
-	Board c(*this);
-	for (int r = 0; r < 8; r++) { 
-	  for (int d = 1; d < flipRadius[r]; d++) { 
-	    c.setColor(x + d * direction[r][0], y + d * direction[r][1], player); 
-	  }
-	}
-	c.setColor(x,y, player);	//place new tile
-	move_bag.emplace_front(x, y, c); // Here is where std::bad_alloc would be thrown
-      }
-    }
+  for(auto legal = legalMoves(player); legal != 0; legal &= legal - 1) {
+    const uint8_t sq = bitscan(legal);
+    Board c(*this);
+    c.play(player, sq);
+    move_bag.emplace_back(sq & 7, sq >> 3, c);
   }
   return move_bag;
 }
@@ -274,22 +168,6 @@ std::ostream& Board::printBig(std::ostream& s) const {
   return s;
 }
 
-/** 
- * Predicate: Is there at least one legal move?
- *
- * @param player The player
- * 
- * @return 
- */
-bool Board::hasLegalMove(Player player) const {
-  uint8_t flipRadius[8];
-  for(auto x = 0; x < w(); ++x)
-    for(auto y = 0; y < h(); ++y)    
-      if( !isFilled(x, y) && findFlipRadius(player, x, y, flipRadius, true) )
-	return true;
-  return false;
-}
-
 /** 
  * Convert Board to a string.
  * 
@@ -306,6 +184,22 @@ Board::operator std::string() const {
 uint8_t Board::w_ = 8;
 uint8_t Board::h_ = 8;
 
+uint64_t Board::board_mask_      = Board::rectMask(0, 8, 0, 8);
+uint64_t Board::inner_cols_mask_ = Board::rectMask(1, 7, 0, 8);
+uint64_t Board::inner_rows_mask_ = Board::rectMask(0, 8, 1, 7);
+
+/** 
+ * Recompute the edge masks used by legalMoves() from
+ * the current board width and height.
+ * 
+ */
+void Board::updateMasks()
+{
+  board_mask_      = rectMask(0, w(), 0, h());
+  inner_cols_mask_ = rectMask(1, w() - 1, 0, h());
+  inner_rows_mask_ = rectMask(0, w(), 1, h() - 1);
+}
+
 /** 
  * Set board width
  * 
@@ -317,6 +211,7 @@ void Board::setW(uint8_t w)
     throw std::logic_error("Unsupported board width");
   }
   Board::w_ = w;
+  updateMasks();
 }
 
 /** 
@@ -330,4 +225,167 @@ void Board::setH(uint8_t h)
     throw std::logic_error("Unsupported board height");
   }
   Board::h_ = h;
+  updateMasks();
+}
+
+/** 
+ * Reflect a bitboard in the vertical axis of the board, by reversing
+ * the bits of each row and shifting them back to the first w()
+ * columns. The squares right of the board, if any, must be empty.
+ * 
+ * @param u 
+ * 
+ * @return 
+ */
+uint64_t Board::mirrorX(uint64_t u)
+{
+  const uint64_t k1 = 0x5555555555555555UL;
+  const uint64_t k2 = 0x3333333333333333UL;
+  const uint64_t k4 = 0x0f0f0f0f0f0f0f0fUL;
+  u = ( ( u >> 1 ) & k1 ) | ( ( u & k1 ) << 1 );
+  u = ( ( u >> 2 ) & k2 ) | ( ( u & k2 ) << 2 );
+  u = ( ( u >> 4 ) & k4 ) | ( ( u & k4 ) << 4 );
+  return u >> ( 8 - w_ );
+}
+
+/** 
+ * Reflect a bitboard in the horizontal axis of the board, by reversing
+ * the order of the rows and shifting them back to the first h() rows.
+ * 
+ * @param u 
+ * 
+ * @return 
+ */
+uint64_t Board::mirrorY(uint64_t u)
+{
+  return __builtin_bswap64(u) >> ( 8 * ( 8 - h_ ) );
+}
+
+/** 
+ * Reflect a bitboard in the diagonal through (0,0), by swapping
+ * the 4x4, 2x2 and 1x1 blocks off the diagonal in turn. A board of
+ * w() == h() < 8 is mapped onto itself.
+ * 
+ * @param u 
+ * 
+ * @return 
+ */
+uint64_t Board::transpose(uint64_t u)
+{
+  const uint64_t k1 = 0x5500550055005500UL;
+  const uint64_t k2 = 0x3333000033330000UL;
+  const uint64_t k4 = 0x0f0f0f0f00000000UL;
+  uint64_t t;
+  t = k4 & ( u ^ ( u << 28 ) );
+  u ^= t ^ ( t >> 28 );
+  t = k2 & ( u ^ ( u << 14 ) );
+  u ^= t ^ ( t >> 14 );
+  t = k1 & ( u ^ ( u << 7 ) );
+  u ^= t ^ ( t >> 7 );
+  return u;
+}
+
+/** 
+ * Apply a symmetry to a bitboard.
+ * 
+ * @param u 
+ * @param t The symmetry
+ * 
+ * @return 
+ */
+uint64_t Board::transformed(uint64_t u, transform_type t)
+{
+  if(t & MIRROR_X) {
+    u = mirrorX(u);
+  }
+  if(t & MIRROR_Y) {
+    u = mirrorY(u);
+  }
+  if(t & TRANSPOSE) {
+    u = transpose(u);
+  }
+  return u;
+}
+
+/** 
+ * The board after a symmetry: the piece on square sq moves to
+ * transform(sq, t).
+ * 
+ * @param t One of 0 to numTransforms()-1
+ * 
+ * @return 
+ */
+Board Board::transformed(transform_type t) const
+{
+  return Board(transformed(filled, t), transformed(white, t));
+}
+
+/** 
+ * The representative of the boards equal to this one up to a
+ * symmetry: the one with the least filled squares, then the least
+ * white squares, as 64-bit numbers. Boards equal up to a symmetry
+ * have the same value and the same moves, up to the symmetry, so
+ * tables of positions may store them once.
+ * 
+ * @return The representative, and a symmetry t such that it is
+ *         transformed(t); the moves of this board are mapped to those
+ *         of the representative by transform(sq, t), and back by
+ *         transform(sq, inverse(t))
+ */
+std::pair<Board, Board::transform_type> Board::canonical() const
+{
+  std::pair<Board, transform_type> best(*this, 0);
+  const int count = numTransforms();
+  for(int t = 1; t < count; ++t) {
+    const uint64_t f = transformed(filled, t);
+    if( f < best.first.filled ) {
+      best = { Board(f, transformed(white, t)), t };
+    } else if( f == best.first.filled ) {
+      const uint64_t u = transformed(white, t);
+      if( u < best.first.white ) {
+	best = { Board(f, u), t };
+      }
+    }
+  }
+  return best;
+}
+
+/** 
+ * The image of a square under a symmetry.
+ * 
+ * @param sq 
+ * @param t 
+ * 
+ * @return 
+ */
+uint8_t Board::transform(uint8_t sq, transform_type t)
+{
+  uint8_t x = sq & 7, y = sq >> 3;
+  if(t & MIRROR_X) {
+    x = w_ - 1 - x;
+  }
+  if(t & MIRROR_Y) {
+    y = h_ - 1 - y;
+  }
+  if(t & TRANSPOSE) {
+    std::swap(x, y);
+  }
+  return square(x, y);
+}
+
+/** 
+ * The inverse of a symmetry. The reflections are their own inverses
+ * and commute, but a reflection in an axis followed by TRANSPOSE is
+ * TRANSPOSE followed by the reflection in the other axis.
+ * 
+ * @param t 
+ * 
+ * @return The symmetry s with transform(transform(sq, t), s) == sq
+ */
+Board::transform_type Board::inverse(transform_type t)
+{
+  if(t & TRANSPOSE) {
+    return TRANSPOSE | ( ( t & MIRROR_X ) ? MIRROR_Y : 0 ) | ( ( t & MIRROR_Y ) ? MIRROR_X : 0 );
+  }
+  return t;
 }
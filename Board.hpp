@@ -17,11 +17,12 @@
 #endif
 
 #include "BoardTraits.hpp"
+#include "MoveList.hpp"
 #include <string>
 #include <iosfwd>
 #include <cinttypes>
-#include <forward_list>
 #include <tuple>
+#include <utility>
 
 
 /** 
@@ -48,28 +49,112 @@ public:
    */
   typedef std::tuple<int, int, Board> move_type;
 
+  /**
+   * Upper bound on the number of legal moves in any position. A move
+   * fills an empty square and the initial position has 60 of them
+   * on the largest board.
+   */
+  static const int MAX_MOVES = 60;
+
   /** 
-   * A collection of moves
+   * A collection of moves. It has a fixed capacity and is stored
+   * in place, so generating moves allocates no memory.
    * 
    */
-  typedef std::forward_list<move_type> move_bag_type;
+  typedef MoveList<move_type, MAX_MOVES> move_bag_type;
 
 public:
   Board();
+
+  /** 
+   * A board with given pieces.
+   * 
+   * @param filled The occupied squares, see filledSquares()
+   * @param white The squares of WHITE, a subset of filled
+   */
+  Board(uint64_t filled, uint64_t white) : filled(filled), white(white) { }
+
   /** Autogenerated copy constuctor */
   Board(const Board&) = default;
 
   /** Autogenerated copy assignment */
   Board& operator=(const Board&) = default;
 
+  /** 
+   * Equality: same pieces on the same squares.
+   * 
+   * @param other 
+   * 
+   * @return 
+   */
+  bool operator==(const Board& other) const
+  {
+    return filled == other.filled && white == other.white;
+  }
+
 public:
   int score() const;
+  int score(Player player) const;
   bool isFilled(uint8_t x, uint8_t y) const; 
   bool isWhite(uint8_t x, uint8_t y) const;
   bool isBlack(uint8_t x, uint8_t y) const;   
   int numTiles() const;
   Board::move_bag_type moves(Board::Player player) const;
   bool hasLegalMove(Player player) const;
+  uint64_t legalMoves(Player player) const;
+  uint64_t flips(Player player, uint8_t sq) const;
+  uint64_t play(Player player, uint8_t sq);
+  void place(Player player, uint8_t sq, uint64_t flips);
+  uint64_t hash(Player player) const;
+
+  /** 
+   * A symmetry of the board, as a combination of the flags below,
+   * applied in their order. TRANSPOSE is a symmetry of square boards
+   * only.
+   */
+  typedef uint8_t transform_type;
+
+  static const transform_type MIRROR_X = 1;  /**< (x,y) to (w()-1-x,y) */
+  static const transform_type MIRROR_Y = 2;  /**< (x,y) to (x,h()-1-y) */
+  static const transform_type TRANSPOSE = 4; /**< (x,y) to (y,x) */
+
+  /** 
+   * @return The number of symmetries of the board: 8 if it is
+   *         square, 4 otherwise; they are 0 to numTransforms()-1
+   */
+  static int numTransforms()
+  {
+    return ( w_ == h_ ) ? 8 : 4;
+  }
+
+  Board transformed(transform_type t) const;
+  std::pair<Board, transform_type> canonical() const;
+  static uint8_t transform(uint8_t sq, transform_type t);
+  static transform_type inverse(transform_type t);
+
+  /** 
+   * @return The occupied squares as a bitboard: bit 8*y+x is set
+   *         iff (x,y) is occupied
+   */
+  uint64_t filledSquares() const { return filled; }
+
+  /** 
+   * @return The squares of WHITE as a bitboard
+   */
+  uint64_t whiteSquares() const { return white; }
+
+  /** 
+   * The square index of (x,y), as used by legalMoves(), flips() and play().
+   * 
+   * @param x 
+   * @param y 
+   * 
+   * @return 8*y+x
+   */
+  static uint8_t square(uint8_t x, uint8_t y)
+  {
+    return (y << 3) | x;
+  }
 
 public:
 
@@ -118,10 +203,6 @@ private:
 
   void setWhite(uint8_t x, uint8_t y); 
   void setBlack(uint8_t x, uint8_t y); 
-  void setColor(uint8_t x, uint8_t y, Player player);
-
-  bool validCoords(int8_t x, int8_t y) const;
-  bool findFlipRadius(Player player, uint8_t x, uint8_t y, uint8_t flipRadius[8], bool shortCircuit = false) const;
 
 private:
 
@@ -131,8 +212,36 @@ private:
   static uint8_t w_;		/**< Board width */
   static uint8_t h_;		/**< Board height */
 
-private: 
+  static uint64_t board_mask_;	/**< Squares inside the w() x h() board */
+  static uint64_t inner_cols_mask_; /**< Board squares not in the first or last column */
+  static uint64_t inner_rows_mask_; /**< Board squares not in the first or last row */
+
+  static const uint64_t SIDE_KEY = 0x9e3779b97f4a7c15UL; /**< Hash key of WHITE to move */
+
+  static uint64_t mix(uint64_t u);
+
+  static uint64_t mirrorX(uint64_t u);
+  static uint64_t mirrorY(uint64_t u);
+  static uint64_t transpose(uint64_t u);
+  static uint64_t transformed(uint64_t u, transform_type t);
+
+  static constexpr uint64_t rectMask(int x0, int x1, int y0, int y1);
+  static void updateMasks();
+
+  template <int S>
+  static uint64_t shift(const uint64_t u);
+
+  template <int S>
+  static uint64_t movesAlong(const uint64_t own, const uint64_t opp);
+
+  template <int S>
+  static uint64_t flipsAlong(const uint64_t move, const uint64_t own, const uint64_t opp);
+
+public: 
   static uint32_t popcount(const uint64_t x);
+  static uint32_t bitscan(const uint64_t x);
+
+private: 
   static bool getbit(const uint64_t& u, uint8_t x, uint8_t y);
   static void setbit(uint64_t& u, uint8_t x, uint8_t y);
   static void unsetbit(uint64_t& u, uint8_t x, uint8_t y);
@@ -169,6 +278,20 @@ uint32_t Board::popcount(const uint64_t x)
   return __builtin_popcountl(x);
 }
 
+/** 
+ * Index of the least significant set bit, i.e. the square 8*y+x
+ * of the first set square. The argument must not be 0.
+ * 
+ * @param x A non-zero 64-bit integer
+ * 
+ * @return 
+ */
+inline
+uint32_t Board::bitscan(const uint64_t x)
+{
+  return __builtin_ctzl(x);
+}
+
 #include <cassert>
 
 #if USE_LUT
@@ -263,6 +386,247 @@ void Board::unsetbit(uint64_t& u, uint8_t x, uint8_t y)
 }
 
 
+/** 
+ * A mask of the squares (x,y) with x0 <= x < x1 and y0 <= y < y1.
+ * 
+ * @param x0 
+ * @param x1 
+ * @param y0 
+ * @param y1 
+ * 
+ * @return 
+ */
+constexpr
+uint64_t Board::rectMask(int x0, int x1, int y0, int y1)
+{
+  uint64_t u = 0;
+  for(int y = y0; y < y1; ++y) {
+    for(int x = x0; x < x1; ++x) {
+      u |= 1UL << ( (y << 3) | x );
+    }
+  }
+  return u;
+}
+
+/** 
+ * Shift all squares of a bitboard by S square indices.  Positive S
+ * moves towards higher indices, i.e. +1 is one step in x, +8 is one
+ * step in y. Squares shifted past either end of the word are lost,
+ * but a horizontal or diagonal shift wraps from one row to the next,
+ * which is why callers mask the shifted set with an edge mask.
+ * 
+ * @param u 
+ * 
+ * @return 
+ */
+template <int S>
+inline
+uint64_t Board::shift(const uint64_t u)
+{
+  if constexpr (S > 0) {
+    return u << S;
+  } else {
+    return u >> -S;
+  }
+}
+
+/** 
+ * Empty squares from which a move along the direction -S flanks a run
+ * of opponent pieces ending at one of the player's pieces.
+ *
+ * This is a parallel prefix (Kogge-Stone) fill: after the first two
+ * steps runs of up to 2 opponent pieces next to own pieces are found,
+ * the pairs in pre then extend them by 2 squares at a time.  A run of
+ * opponent pieces on an 8-wide board is at most 6 long, so 4 steps
+ * suffice. The caller must remove from opp the pieces on the edge
+ * that a shift by S would wrap around, and mask the result with the
+ * empty squares of the board.
+ * 
+ * @param own Pieces of the player to move
+ * @param opp Pieces of the opponent, edge-masked for direction S
+ * 
+ * @return Candidate move squares (not yet masked)
+ */
+template <int S>
+inline
+uint64_t Board::movesAlong(const uint64_t own, const uint64_t opp)
+{
+  uint64_t flip = opp & shift<S>(own);
+  flip |= opp & shift<S>(flip);
+  const uint64_t pre = opp & shift<S>(opp);
+  flip |= pre & shift<2*S>(flip);
+  flip |= pre & shift<2*S>(flip);
+  return shift<S>(flip);
+}
+
+/** 
+ * The legal moves of a player as a bitboard: bit 8*y+x is set
+ * iff placing a piece at (x,y) flips at least one opponent piece.
+ *
+ * All 8 directions are computed with a few shifts of the whole board,
+ * rather than by walking rays one square at a time. The edge masks
+ * depend on the current w() and h(), so that no run can wrap around
+ * the board edge for any supported board size.
+ * 
+ * @param player 
+ * 
+ * @return A mask of legal move squares.
+ */
+inline uint64_t Board::legalMoves(Player player) const
+{
+  const uint64_t own = ( player == WHITE ) ? white : filled ^ white;
+  const uint64_t opp = filled ^ own;
+  const uint64_t horz = opp & inner_cols_mask_;
+  const uint64_t vert = opp & inner_rows_mask_;
+  const uint64_t diag = horz & inner_rows_mask_;
+
+  const uint64_t moves =
+    movesAlong< 1>(own, horz) | movesAlong<-1>(own, horz) |
+    movesAlong< 8>(own, vert) | movesAlong<-8>(own, vert) |
+    movesAlong< 7>(own, diag) | movesAlong<-7>(own, diag) |
+    movesAlong< 9>(own, diag) | movesAlong<-9>(own, diag);
+
+  return moves & ~filled & board_mask_;
+}
+
+/** 
+ * The run of opponent pieces flipped along the direction S by
+ * a move, i.e. the opponent pieces adjacent to the move in that
+ * direction, provided the run ends at one of the player's pieces.
+ * The run is found with the same parallel prefix steps as
+ * in movesAlong().
+ * 
+ * @param move The square of the move, as a one-bit mask
+ * @param own Pieces of the player to move
+ * @param opp Pieces of the opponent, edge-masked for direction S
+ * 
+ * @return Pieces to flip, or 0
+ */
+template <int S>
+inline
+uint64_t Board::flipsAlong(const uint64_t move, const uint64_t own, const uint64_t opp)
+{
+  uint64_t run = opp & shift<S>(move);
+  run |= opp & shift<S>(run);
+  const uint64_t pre = opp & shift<S>(opp);
+  run |= pre & shift<2*S>(run);
+  run |= pre & shift<2*S>(run);
+  return ( shift<S>(run) & own ) ? run : 0;
+}
+
+/** 
+ * The pieces flipped by a move of a player at a square.
+ * 
+ * @param player 
+ * @param sq Square index, see square()
+ * 
+ * @return A mask of the opponent pieces that become the player's.
+ *         It is 0 iff the move is illegal.
+ */
+inline uint64_t Board::flips(Player player, uint8_t sq) const
+{
+  assert(sq < 64);
+  const uint64_t own = ( player == WHITE ) ? white : filled ^ white;
+  const uint64_t opp = filled ^ own;
+  const uint64_t horz = opp & inner_cols_mask_;
+  const uint64_t vert = opp & inner_rows_mask_;
+  const uint64_t diag = horz & inner_rows_mask_;
+  const uint64_t move = 1UL << sq;
+
+  return
+    flipsAlong< 1>(move, own, horz) | flipsAlong<-1>(move, own, horz) |
+    flipsAlong< 8>(move, own, vert) | flipsAlong<-8>(move, own, vert) |
+    flipsAlong< 7>(move, own, diag) | flipsAlong<-7>(move, own, diag) |
+    flipsAlong< 9>(move, own, diag) | flipsAlong<-9>(move, own, diag);
+}
+
+/** 
+ * Make a move: place a piece of the player at a square and flip
+ * the flanked opponent pieces. A flip toggles the white bit of a
+ * filled square, so the whole move is two XORs. The move must be
+ * legal.
+ * 
+ * @param player 
+ * @param sq Square index, see square()
+ * 
+ * @return The flipped pieces, as returned by flips()
+ */
+inline uint64_t Board::play(Player player, uint8_t sq)
+{
+  const uint64_t f = flips(player, sq);
+  place(player, sq, f);
+  return f;
+}
+
+/** 
+ * Make a move whose flips are already known, like play().
+ * 
+ * @param player 
+ * @param sq Square index, see square()
+ * @param flips The flips of the move, as returned by flips()
+ */
+inline void Board::place(Player player, uint8_t sq, uint64_t flips)
+{
+  const uint64_t move = 1UL << sq;
+  assert( !(filled & move) );
+  assert( flips != 0 );
+  filled ^= move;
+  white ^= flips | ( ( player == WHITE ) ? move : 0 );
+}
+
+/** 
+ * The 64-bit finalizer of MurmurHash3. It is a bijection in which
+ * every input bit affects every output bit with probability
+ * close to 1/2.
+ * 
+ * @param u 
+ * 
+ * @return 
+ */
+inline uint64_t Board::mix(uint64_t u)
+{
+  u ^= u >> 33;
+  u *= 0xff51afd7ed558ccdUL;
+  u ^= u >> 33;
+  u *= 0xc4ceb9fe1a85ec53UL;
+  u ^= u >> 33;
+  return u;
+}
+
+/** 
+ * A 64-bit hash of the position, i.e. of the board and the player to
+ * move. It needs no tables: the occupied squares are mixed, combined
+ * with the white squares and mixed again, and the side to move is
+ * XOR-ed in last. It costs two multiply-xorshift rounds,
+ * a few nanoseconds.
+ *
+ * Collisions: for a fixed set of filled squares and player to move,
+ * different colourings never collide, as mix() is a bijection.
+ * Otherwise the hash behaves as a random 64-bit number, so among N
+ * distinct positions about N*N/2^65 pairs collide: less than 0.03
+ * for a billion positions. Tables that index by the low bits and
+ * verify the full hash share this rate.
+ * 
+ * @param player The player to move
+ * 
+ * @return 
+ */
+inline uint64_t Board::hash(Player player) const
+{
+  return mix(mix(filled) ^ white) ^ ( ( player == WHITE ) ? SIDE_KEY : 0 );
+}
+
+/** 
+ * Predicate: Is there at least one legal move?
+ *
+ * @param player The player
+ * 
+ * @return 
+ */
+inline bool Board::hasLegalMove(Player player) const {
+  return legalMoves(player) != 0;
+}
+
 /** 
  * # of white tiles - # black tiles
  * 
@@ -273,6 +637,17 @@ inline int Board::score () const {
   return numWhiteTiles() - numBlackTiles();
 }
 
+/** 
+ * The score from the point of view of a player.
+ * 
+ * @param player
+ * 
+ * @return The pieces of the player minus those of the opponent
+ */
+inline int Board::score(Player player) const {
+  return ( player == WHITE ) ? score() : -score();
+}
+
 /** 
  * Returns the number of tiles on the board.
  * 
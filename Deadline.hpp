@@ -0,0 +1,98 @@
+/**
+ * @file   Deadline.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 16:25:51 2026
+ * 
+ * @brief  Wall-clock limit on the time of a search
+ * 
+ * 
+ */
+
+#ifndef DEADLINE_HPP
+#define DEADLINE_HPP
+
+#include <chrono>
+#include <atomic>
+#include <stdexcept>
+#include <cinttypes>
+
+/**
+ * A wall-clock deadline for the search of a move. Searches call
+ * check() at every node; once the deadline has passed, check() throws
+ * Expired, which unwinds the search. Reading the clock costs more
+ * than a node, so the clock is read once per CHECK_INTERVAL calls.
+ * 
+ */
+class Deadline {
+public:
+
+  /**
+   * Thrown by check() when the time is up.
+   * 
+   */
+  struct Expired : public std::runtime_error {
+    Expired() : std::runtime_error("Search deadline expired") { }
+  };
+
+  /** 
+   * Set the deadline to some time from now.
+   * 
+   * @param ms Milliseconds from now
+   */
+  static void start(int ms)
+  {
+    expired_ = false;
+    deadline_ = now() + static_cast<int64_t>(ms) * 1000000;
+  }
+
+  /** 
+   * Remove the deadline.
+   */
+  static void stop()
+  {
+    deadline_ = 0;
+    expired_ = false;
+  }
+
+  /** 
+   * @return True if there is a deadline and it has passed.
+   */
+  static bool expired()
+  {
+    if( deadline_ != 0 && now() >= deadline_ ) {
+      expired_ = true;
+    }
+    return expired_;
+  }
+
+  /** 
+   * Called by the search at every node.
+   * 
+   * @throw Expired if the deadline has passed
+   */
+  static void check()
+  {
+    if( deadline_ != 0 && ( ++counter_ % CHECK_INTERVAL ) == 0 && expired() ) {
+      throw Expired();
+    }
+  }
+
+private:
+
+  static const unsigned CHECK_INTERVAL = 1024; /**< Nodes between reading the clock */
+
+  /** 
+   * @return Monotonic time in nanoseconds
+   */
+  static int64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+      (std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  static inline std::atomic<int64_t> deadline_ = 0; /**< In nanoseconds, 0 if none */
+  static inline std::atomic<bool> expired_ = false; /**< Deadline passed */
+  static inline thread_local unsigned counter_ = 0; /**< Calls of check() */
+};
+
+#endif	// DEADLINE_HPP
@@ -0,0 +1,369 @@
+/**
+ * @file   EndgameSolver.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 09:15:37 2026
+ *
+ * @brief  Exact solver of the end of the game, implementation
+ *
+ *
+ */
+
+#include "EndgameSolver.hpp"
+#include "Deadline.hpp"
+#include "TranspositionTable.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+const SimpleStaticEvaluator EndgameSolver::scoreKey;
+
+namespace {
+  /**
+   * The preference of a square, for the order of the list of empty
+   * squares.
+   *
+   * @param x
+   * @param y
+   *
+   * @return 0 for a corner, 1 for another edge square, 2 for an inner
+   *         square and 3 for a square next to a corner
+   */
+  int rank(int x, int y)
+  {
+    const int dx = std::min(x, Board::w() - 1 - x);
+    const int dy = std::min(y, Board::h() - 1 - y);
+    if( dx == 0 && dy == 0 ) {
+      return 0;
+    } else if( dx <= 1 && dy <= 1 ) {
+      return 3;
+    } else if( dx == 0 || dy == 0 ) {
+      return 1;
+    } else {
+      return 2;
+    }
+  }
+}
+
+/**
+ * Constructor.
+ *
+ */
+EndgameSolver::EndgameSolver()
+  : parity_(0),
+    nodes_(0)
+{
+  next_[END] = prev_[END] = END;
+}
+
+/**
+ * Make the list of the empty squares of a board, by rank(), and
+ * their parity.
+ *
+ * @param board
+ */
+void EndgameSolver::init(const Board& board)
+{
+  parity_ = 0;
+  next_[END] = prev_[END] = END;
+  for(int r = 0; r < 4; ++r) {
+    for(int y = 0; y < Board::h(); ++y) {
+      for(int x = 0; x < Board::w(); ++x) {
+	if( rank(x, y) != r || board.isFilled(x, y) ) {
+	  continue;
+	}
+	const uint8_t sq = Board::square(x, y);
+	quadrant_[sq] = ( x >= Board::w() / 2 ) | ( ( y >= Board::h() / 2 ) << 1 );
+	prev_[sq] = prev_[END];
+	next_[sq] = END;
+	next_[prev_[END]] = sq;
+	prev_[END] = sq;
+	parity_ ^= 1u << quadrant_[sq];
+      }
+    }
+  }
+}
+
+/**
+ * The exact value of a board.
+ *
+ * @param board
+ * @param player The player to move
+ *
+ * @return The final score, i.e. the value for WHITE, as computed by
+ *         TreeNode::minmax()
+ *
+ * @throw Deadline::Expired
+ */
+StaticEvaluatorTraits::value_type
+EndgameSolver::value(const Board& board, BoardTraits::Player player)
+{
+  init(board);
+  const int empties = Board::w() * Board::h() - board.numTiles();
+  const int val = solve(board, player, empties, -INF, INF, false);
+  return ( player == Board::WHITE ) ? val : -val;
+}
+
+/**
+ * The final score for the player to move, searched with a window.
+ *
+ * @param board
+ * @param player The player to move
+ * @param alpha Most the player to move can already achieve
+ * @param beta  Least the opponent can already hold the player to
+ *
+ * @return The score if it is inside (alpha, beta), else a bound on
+ *         the side of the window it falls
+ *
+ * @throw Deadline::Expired
+ */
+int EndgameSolver::negamax(const Board& board, BoardTraits::Player player, int alpha, int beta)
+{
+  init(board);
+  const int empties = Board::w() * Board::h() - board.numTiles();
+  return solve(board, player, empties, alpha, beta, false);
+}
+
+/**
+ * Finds all moves of a player leading to the best final score. Like
+ * Search::bestMoves(), each move is searched with a window just below
+ * the best value found so far.
+ *
+ * @param board
+ * @param player The player to move
+ *
+ * @return The squares of all best moves, or an empty list if the
+ *         player must pass.
+ *
+ * @throw Deadline::Expired
+ */
+EndgameSolver::squares_type
+EndgameSolver::bestMoves(const Board& board, BoardTraits::Player player)
+{
+  init(board);
+  const int empties = Board::w() * Board::h() - board.numTiles();
+  squares_type best;
+  int bestVal = -INF;
+  for(uint8_t sq = next_[END]; sq != END; sq = next_[sq]) {
+    const uint64_t f = board.flips(player, sq);
+    if(f == 0) {
+      continue;
+    }
+    Board child(board);
+    child.place(player, sq, f);
+    remove(sq);
+    const int val = -solve(child, ~player, empties - 1, -INF, -( bestVal - 1 ), false);
+    restore(sq);
+    if(val > bestVal) {
+      bestVal = val;
+      best.clear();
+    }
+    if(val == bestVal) {
+      best.push_back(sq);
+    }
+  }
+  return best;
+}
+
+/**
+ * Fail-soft alpha-beta search to the end of the game, in negamax
+ * form: the value is from the point of view of the player to move.
+ * An exception leaves the list of empty squares inconsistent, until
+ * the next init().
+ *
+ * @param board
+ * @param player The player to move
+ * @param empties The number of empty squares, i.e. on the list
+ * @param alpha Most the player to move can already achieve
+ * @param beta  Least the opponent can already hold the player to
+ * @param passed True if the opponent has just passed
+ *
+ * @return The final score for the player to move
+ *
+ * @throw Deadline::Expired
+ */
+int EndgameSolver::solve(const Board& board, BoardTraits::Player player, int empties,
+			 int alpha, int beta, bool passed)
+{
+  if(empties <= 4) {
+    // The squares in odd quadrants first
+    uint8_t squares[4];
+    int n = 0;
+    for(unsigned odd : {1u, 0u}) {
+      for(uint8_t sq = next_[END]; sq != END; sq = next_[sq]) {
+	if( ( ( parity_ >> quadrant_[sq] ) & 1 ) == odd ) {
+	  squares[n++] = sq;
+	}
+      }
+    }
+    switch(n) {
+    case 1: return solveLast<1>(board, player, squares, alpha, beta, passed);
+    case 2: return solveLast<2>(board, player, squares, alpha, beta, passed);
+    case 3: return solveLast<3>(board, player, squares, alpha, beta, passed);
+    case 4: return solveLast<4>(board, player, squares, alpha, beta, passed);
+    default: return board.score(player);
+    }
+  }
+
+  ++nodes_;
+  Deadline::check();
+  const uint64_t legal = board.legalMoves(player);
+  if(legal == 0) {
+    if(passed) {		// Neither player can move
+      return board.score(player);
+    }
+    return -solve(board, ~player, empties, -beta, -alpha, true);
+  }
+
+  // The table holds values and bounds for WHITE, see Search
+  const bool white = ( player == Board::WHITE );
+  auto& table = TranspositionTable::getInstance();
+  const bool useTable = ( empties >= TABLE_EMPTIES );
+  const uint64_t key = useTable ? TranspositionTable::key(board.hash(player), scoreKey) : 0;
+  uint8_t ttMove = TranspositionTable::NO_MOVE;
+  TranspositionTable::Entry entry;
+  if( useTable && table.probe(key, entry) ) {
+    if( entry.depth == empties ) {
+      const int val = white ? entry.value : -entry.value;
+      const auto lower = white ? TranspositionTable::LOWER : TranspositionTable::UPPER;
+      const auto upper = white ? TranspositionTable::UPPER : TranspositionTable::LOWER;
+      if( entry.bound == TranspositionTable::EXACT
+	  || ( entry.bound == lower && val >= beta )
+	  || ( entry.bound == upper && val <= alpha ) ) {
+	table.countCutoff();
+	return val;
+      }
+    }
+    ttMove = entry.move;
+  }
+
+  // The moves in the order of search
+  uint8_t squares[Board::MAX_MOVES];
+  uint64_t flips[Board::MAX_MOVES];
+  int n = 0;
+  if(empties > ORDER_EMPTIES) {
+    // Fastest first: fewest replies, then odd quadrants
+    int order[Board::MAX_MOVES];
+    for(uint8_t sq = next_[END]; sq != END; sq = next_[sq]) {
+      if( ( ( legal >> sq ) & 1 ) == 0 ) {
+	continue;
+      }
+      const uint64_t f = board.flips(player, sq);
+      Board child(board);
+      child.place(player, sq, f);
+      const int o = ( sq == ttMove ) ? -1
+	: 2 * Board::popcount(child.legalMoves(~player)) + 1 - ( ( parity_ >> quadrant_[sq] ) & 1 );
+      // Insertion sort, keeping the order of the list for equal order
+      int j = n++;
+      for(/* Empty */; j > 0 && order[j-1] > o; --j) {
+	order[j] = order[j-1];
+	squares[j] = squares[j-1];
+	flips[j] = flips[j-1];
+      }
+      order[j] = o;
+      squares[j] = sq;
+      flips[j] = f;
+    }
+  } else {
+    for(unsigned odd : {1u, 0u}) {
+      for(uint8_t sq = next_[END]; sq != END; sq = next_[sq]) {
+	if( ( ( legal >> sq ) & 1 ) && ( ( parity_ >> quadrant_[sq] ) & 1 ) == odd ) {
+	  squares[n] = sq;
+	  flips[n] = board.flips(player, sq);
+	  ++n;
+	}
+      }
+    }
+  }
+
+  const int alpha0 = alpha;
+  int bestVal = -INF;
+  uint8_t bestMove = TranspositionTable::NO_MOVE;
+  for(int i = 0; i < n; ++i) {
+    Board child(board);
+    child.place(player, squares[i], flips[i]);
+    remove(squares[i]);
+    const int val = -solve(child, ~player, empties - 1, -beta, -alpha, false);
+    restore(squares[i]);
+    if(val > bestVal) {
+      bestVal = val;
+      bestMove = squares[i];
+      alpha = std::max(alpha, bestVal);
+      if(alpha >= beta) {
+	break;
+      }
+    }
+  }
+
+  if(useTable) {
+    const auto bound = ( bestVal <= alpha0 ) ? ( white ? TranspositionTable::UPPER : TranspositionTable::LOWER )
+      : ( bestVal >= beta ) ? ( white ? TranspositionTable::LOWER : TranspositionTable::UPPER )
+      : TranspositionTable::EXACT;
+    table.store(key, white ? bestVal : -bestVal, bound, empties, bestMove);
+  }
+  return bestVal;
+}
+
+/**
+ * Solve the last N empty squares. The squares are passed in an array,
+ * rather than found on the list, and the recursion is unrolled by the
+ * compiler, one routine for each N. With one empty square, the final
+ * score follows from the number of flips alone.
+ *
+ * @param board
+ * @param player The player to move
+ * @param squares The N empty squares, in the order of search
+ * @param alpha
+ * @param beta
+ * @param passed True if the opponent has just passed
+ *
+ * @return The final score for the player to move
+ */
+template <int N>
+int EndgameSolver::solveLast(const Board& board, BoardTraits::Player player, const uint8_t* squares,
+			     int alpha, int beta, bool passed)
+{
+  ++nodes_;
+  if constexpr (N == 1) {
+    const int val = board.score(player);
+    uint64_t f = board.flips(player, squares[0]);
+    if(f != 0) {
+      return val + 2 * Board::popcount(f) + 1;
+    }
+    f = board.flips(~player, squares[0]);
+    if(f != 0) {
+      return val - 2 * Board::popcount(f) - 1;
+    }
+    return val;
+  } else {
+    int bestVal = -INF;
+    for(int i = 0; i < N; ++i) {
+      const uint64_t f = board.flips(player, squares[i]);
+      if(f == 0) {
+	continue;
+      }
+      Board child(board);
+      child.place(player, squares[i], f);
+      uint8_t rest[N - 1];
+      for(int j = 0, k = 0; j < N; ++j) {
+	if(j != i) {
+	  rest[k++] = squares[j];
+	}
+      }
+      const int val = -solveLast<N - 1>(child, ~player, rest, -beta, -alpha, false);
+      if(val > bestVal) {
+	bestVal = val;
+	alpha = std::max(alpha, bestVal);
+	if(alpha >= beta) {
+	  break;
+	}
+      }
+    }
+    if(bestVal == -INF) {	// No move
+      if(passed) {
+	return board.score(player);
+      }
+      return -solveLast<N>(board, ~player, squares, -beta, -alpha, true);
+    }
+    return bestVal;
+  }
+}
@@ -0,0 +1,107 @@
+/**
+ * @file   EndgameSolver.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 09:14:52 2026
+ *
+ * @brief  Exact solver of the end of the game
+ *
+ * Searches Board values on the stack, like Search, but only to the
+ * end of the game, with no static evaluator.
+ */
+
+#ifndef ENDGAME_SOLVER_HPP
+#define ENDGAME_SOLVER_HPP
+
+#include "Board.hpp"
+#include "MoveList.hpp"
+#include "StaticEvaluator.hpp"
+#include "SimpleStaticEvaluator.hpp"
+
+#include <cinttypes>
+
+/**
+ * Finds the final score, the number of white minus the number of
+ * black pieces, when both players play perfectly from a position.
+ *
+ * The solver is meant for the last 20 or so empty squares. Rather
+ * than the whole board, it scans a list of the empty squares, kept
+ * in the order of a fixed preference of squares (corners first,
+ * squares next to corners last). With many empty squares, the moves
+ * leaving the opponent the fewest replies are searched first (fastest
+ * first) and values are kept in the TranspositionTable. With few,
+ * moves into a quadrant with an odd number of empty squares are
+ * searched first (parity), as the player moving last in a region
+ * tends to gain. The last 4 empty squares are solved by routines
+ * specialised for their number, see solveLast().
+ *
+ */
+class EndgameSolver : public StaticEvaluatorTraits {
+public:
+  /**
+   * A list of squares, see Board::square()
+   *
+   */
+  typedef MoveList<uint8_t, Board::MAX_MOVES> squares_type;
+
+  EndgameSolver();
+
+  value_type value(const Board& board, BoardTraits::Player player);
+
+  int negamax(const Board& board, BoardTraits::Player player, int alpha, int beta);
+
+  squares_type bestMoves(const Board& board, BoardTraits::Player player);
+
+  /**
+   * @return The number of nodes visited so far.
+   */
+  uint64_t nodes() const { return nodes_; }
+
+private:
+
+  static const int INF = 65;		/**< Above any score */
+  static const uint8_t END = 64;	/**< Head and tail of the list of empty squares */
+  static const int ORDER_EMPTIES = 7;	/**< Above, fastest first; else parity */
+  static const int TABLE_EMPTIES = 9;	/**< From, use the TranspositionTable */
+
+  static const SimpleStaticEvaluator scoreKey; /**< Its id keys the table entries of the solver */
+
+  void init(const Board& board);
+
+  /**
+   * Take a square off the list of empty squares.
+   *
+   * @param sq
+   */
+  void remove(uint8_t sq)
+  {
+    next_[prev_[sq]] = next_[sq];
+    prev_[next_[sq]] = prev_[sq];
+    parity_ ^= 1u << quadrant_[sq];
+  }
+
+  /**
+   * Put back the square last taken off the list by remove().
+   *
+   * @param sq
+   */
+  void restore(uint8_t sq)
+  {
+    next_[prev_[sq]] = sq;
+    prev_[next_[sq]] = sq;
+    parity_ ^= 1u << quadrant_[sq];
+  }
+
+  int solve(const Board& board, BoardTraits::Player player, int empties, int alpha, int beta, bool passed);
+
+  template <int N>
+  int solveLast(const Board& board, BoardTraits::Player player, const uint8_t* squares,
+		int alpha, int beta, bool passed);
+
+  uint8_t next_[END + 1];	/**< Next empty square, or END */
+  uint8_t prev_[END + 1];	/**< Previous empty square, or END */
+  uint8_t quadrant_[END];	/**< Quadrant of each square, 0 to 3 */
+  unsigned parity_;		/**< Bit q is set iff quadrant q has an odd number of empty squares */
+  uint64_t nodes_;		/**< Node counter */
+};
+
+#endif	// ENDGAME_SOLVER_HPP
@@ -12,10 +12,15 @@
 #include <ctime>
 #include <iomanip>
 #include <numeric>
+#include <algorithm>
 #include <memory>
 
 #include "MainLoop.hpp"
 #include "TreeNode.hpp"
+#include "TranspositionTable.hpp"
+#include "MoveOrdering.hpp"
+#include "NodeArena.hpp"
+#include "Reclaimer.hpp"
 #include "SimpleStaticEvaluator.hpp"
 //#include "CornerStaticEvaluator.hpp"
 
@@ -26,6 +31,19 @@ int  MainLoop::num_games      = DEFAULT_NUM_GAMES;
 int  MainLoop::computer_delay = DEFAULT_COMPUTER_DELAY;
 bool MainLoop::prune          = DEFAULT_PRUNE;
 
+/** 
+ * Make a move: the node of the move becomes the root, and the rest of
+ * the tree is handed to the Reclaimer.
+ * 
+ * @param root The root, replaced by next
+ * @param next A node moved out of the tree of root
+ */
+void MainLoop::advance(TreeNode& root, TreeNode&& next)
+{
+  Reclaimer::getInstance().discard(std::move(root));
+  root = std::move(next);
+}
+
 /** 
  * Play a game, return the score.
  * 
@@ -35,7 +53,16 @@ bool MainLoop::prune          = DEFAULT_PRUNE;
  */
 int MainLoop::play(int game, const StaticEvaluatorTable& evaluatorTab)
 {
+  Reclaimer::getInstance().wait();
+  Reclaimer::getInstance().resetStats();
+  NodeArena<TreeNode>::getInstance().trim();
+  NodeArena<TreeNode>::getInstance().resetPeak();
+  TreeNode::evictions = 0;
+  TreeNode::splits = 0;
+  TreeNode::nodes = 0;
   TreeNode root;
+  TranspositionTable::getInstance().resetStats();
+  MoveOrdering::clearAll();
   
   std::cout << root << std::endl;
   while(!root.isLeaf()) {
@@ -46,16 +73,21 @@ int MainLoop::play(int game, const StaticEvaluatorTable& evaluatorTab)
 	      << "----------------------------------------------------------------\n"
 	      << std::endl;
     if( humanPlayer[root.player()] ) {
-      root = root.getHumanMove(std::cin);
+      advance(root, root.getHumanMove(std::cin));
       std::cout << "Human played: " << root.x() << " " << root.y() << std::endl;
       std::clog << root.x() << ' ' << root.y() << "\t// Game #:" << game << ",  " << p << ", " << 'H' << "\n";
     } else {			// not human
       ::sleep(computer_delay);
-      root = root.getComputerMove(evaluatorTab, max_depth[root.player()], prune);
+      advance(root, root.getComputerMove(evaluatorTab, max_depth[root.player()], prune));
       std::cout << root.board() << std::flush
 		<< "----------------------------------------------------------------\n"
 		<< "Game #" << game << ": Computer played: " << root.x() << " " << root.y() << "\n"
-		<< "----------------------------------------------------------------\n" 
+		<< "Search depth: " << TreeNode::search_depth << "\n";
+      if(TreeNode::wld && TreeNode::solved) {
+	std::cout << "Outcome with perfect play: "
+		  << ( root.minMaxVal() > 0 ? "WHITE wins" : root.minMaxVal() < 0 ? "BLACK wins" : "a draw" ) << "\n";
+      }
+      std::cout << "----------------------------------------------------------------\n" 
 		<< std::endl;
       std::clog << root.x() << ' ' << root.y() << "\t// Game #:" << game << ",  " << p << ", " << 'C' << "\n";
       if(computer_delay > 0) {
@@ -69,6 +101,13 @@ int MainLoop::play(int game, const StaticEvaluatorTable& evaluatorTab)
 	    << "Game #" << game << ": THE GAME ENDED.\n"
 	    << "----------------------------------------------------------------\n"
 	    << std::endl;
+  TranspositionTable::getInstance().printStats(std::cout);
+  MoveOrdering::printAllStats(std::cout);
+  NodeArena<TreeNode>::getInstance().printStats(std::cout);
+  std::cout << "Searched nodes: " << TreeNode::nodes
+	    << ", evicted subtrees: " << TreeNode::evictions
+	    << ", parallel splits: " << TreeNode::splits << std::endl;
+  Reclaimer::getInstance().printStats(std::cout);
   if( root.score() > 0) {
     std::cout << root << std::flush
 	      << "WHITE won!!! Score " << root.score()
@@ -167,6 +206,18 @@ const MainLoop& MainLoop::reportSettings() const
     << "\nBoard width: " <<  static_cast<unsigned>(Board::w())
     << "\nBoard height: " << static_cast<unsigned>(Board::h())
     << "\nUse alpha beta pruning: " << std::boolalpha << prune
+    << "\nSearch algorithm: " << ( TreeNode::algorithm == SearchTraits::PVS ? "PVS"
+				    : TreeNode::algorithm == SearchTraits::MTDF ? "MTD(f)" : "alpha-beta" )
+    << "\nSearch backend: " << ( TreeNode::backend == SearchTraits::STACK ? "STACK" : "TREE" )
+    << "\nThreads: " << TreeNode::threads
+    << ( TreeNode::parallel == SearchTraits::YBWC ? " (YBWC)"
+	 : TreeNode::parallel == SearchTraits::LAZY_SMP ? " (Lazy SMP)" : " (root split)" )
+    << "\nTime per move: " << TreeNode::move_time_ms << " ms"
+    << "\nSolve the endgame from empty squares: " << TreeNode::endgame_empties
+    << "\nOnly find the winner when solving: " << std::boolalpha << TreeNode::wld
+    << "\nDelete trees in the background: " << std::boolalpha << Reclaimer::async
+    << "\nGame tree limit: " << ( TreeNode::max_nodes * sizeof(TreeNode) >> 20 ) << " MB"
+    << "\nTransposition table size: " << ( TranspositionTable::getInstance().bytes() >> 20 ) << " MB"
     << std::endl;
 
   return *this;
@@ -223,3 +274,53 @@ const MainLoop& MainLoop::setPruning(int value) const {
   return *this;
 }
 
+const MainLoop& MainLoop::setBackend(SearchTraits::Backend backend) const {
+  TreeNode::backend = backend;
+  return *this;
+}
+
+const MainLoop& MainLoop::setMoveTime(int ms) const {
+  TreeNode::move_time_ms = ms;
+  return *this;
+}
+
+const MainLoop& MainLoop::setMaxTreeSize(int megabytes) const {
+  TreeNode::max_nodes = ( size_t(megabytes) << 20 ) / sizeof(TreeNode);
+  return *this;
+}
+
+const MainLoop& MainLoop::setAsyncFree(bool async) const {
+  Reclaimer::async = async;
+  return *this;
+}
+
+const MainLoop& MainLoop::setThreads(int threads) const {
+  TreeNode::threads = std::max(threads, 1);
+  return *this;
+}
+
+const MainLoop& MainLoop::setParallel(SearchTraits::Parallel parallel) const {
+  TreeNode::parallel = parallel;
+  return *this;
+}
+
+const MainLoop& MainLoop::setAlgorithm(SearchTraits::Algorithm algorithm) const {
+  TreeNode::algorithm = algorithm;
+  return *this;
+}
+
+const MainLoop& MainLoop::setEndgameEmpties(int empties) const {
+  TreeNode::endgame_empties = empties;
+  return *this;
+}
+
+const MainLoop& MainLoop::setWld(bool wld) const {
+  TreeNode::wld = wld;
+  return *this;
+}
+
+const MainLoop& MainLoop::setHashSize(int megabytes) const {
+  TranspositionTable::getInstance().resize(megabytes);
+  return *this;
+}
+
@@ -12,6 +12,9 @@
 
 #include <iosfwd>
 #include "StaticEvaluator.hpp"
+#include "SearchTraits.hpp"
+
+class TreeNode;
 
 /**
  * This class runs the game loop and controls 
@@ -126,6 +129,103 @@ public:
    */
   const MainLoop& setPruning(int value) const;
 
+  /** 
+   * Select the search implementation used for computer moves.
+   * 
+   * @param backend 
+   * 
+   * @return *this
+   */
+  const MainLoop& setBackend(SearchTraits::Backend backend) const;
+
+  /** 
+   * Set the size of the transposition table.
+   * 
+   * @param megabytes Size in MB, 0 disables the table
+   * 
+   * @return *this
+   */
+  const MainLoop& setHashSize(int megabytes) const;
+
+  /** 
+   * Set the time budget of a computer move. The computer then deepens
+   * its search until the time is up, up to its maximum depth.
+   * 
+   * @param ms Milliseconds per move, 0 for a fixed depth search
+   * 
+   * @return *this
+   */
+  const MainLoop& setMoveTime(int ms) const;
+
+  /** 
+   * Limit the memory of the game tree. Subtrees already searched are
+   * deleted when the tree grows beyond the limit, and searched again
+   * if needed.
+   * 
+   * @param megabytes Size in MB, 0 for no limit
+   * 
+   * @return *this
+   */
+  const MainLoop& setMaxTreeSize(int megabytes) const;
+
+  /** 
+   * Delete the discarded parts of the game tree in a background
+   * thread, or on the move path.
+   * 
+   * @param async 
+   * 
+   * @return *this
+   */
+  const MainLoop& setAsyncFree(bool async) const;
+
+  /** 
+   * Set the number of threads searching the moves of the computer
+   * in parallel.
+   * 
+   * @param threads 1 for a serial search
+   * 
+   * @return *this
+   */
+  const MainLoop& setThreads(int threads) const;
+
+  /** 
+   * Select how the threads share the search.
+   * 
+   * @param parallel 
+   * 
+   * @return *this
+   */
+  const MainLoop& setParallel(SearchTraits::Parallel parallel) const;
+
+  /** 
+   * Select the algorithm of the search with pruning.
+   * 
+   * @param algorithm 
+   * 
+   * @return *this
+   */
+  const MainLoop& setAlgorithm(SearchTraits::Algorithm algorithm) const;
+
+  /** 
+   * Set the number of empty squares from which the computer solves
+   * the game exactly.
+   * 
+   * @param empties 0 to never solve
+   * 
+   * @return *this
+   */
+  const MainLoop& setEndgameEmpties(int empties) const;
+
+  /** 
+   * Only find the winner in the search without pruning at depth 128
+   * or more, see TreeNode::searchOutcome().
+   * 
+   * @param wld 
+   * 
+   * @return *this
+   */
+  const MainLoop& setWld(bool wld) const;
+
 
   /** 
    * Reports current settings
@@ -156,6 +256,7 @@ public:
 private:
 
   static int play(int game, const StaticEvaluatorTable& evaluatorTab);
+  static void advance(TreeNode& root, TreeNode&& next);
 };
 
 #endif /* MAIN_LOOP */
@@ -0,0 +1,133 @@
+/**
+ * @file   MoveList.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 10:12:44 2026
+ *
+ * @brief  A fixed capacity list of moves
+ *
+ * The list lives on the stack, so generating moves does no heap
+ * allocation at all.
+ */
+
+#ifndef MOVE_LIST_HPP
+#define MOVE_LIST_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <cassert>
+
+/**
+ * A list of at most N elements of type T, stored in place.
+ * Elements are appended at the end and the list can be iterated
+ * like a standard container. Storage is not initialized
+ * until an element is added, so T need not have a cheap default
+ * constructor.
+ *
+ */
+template <typename T, std::size_t N>
+class MoveList {
+  static_assert(std::is_trivially_destructible_v<T>,
+		"Elements of MoveList are never destroyed");
+public:
+  typedef T value_type;		/**< Element type */
+  typedef T* iterator;		/**< Iterator type */
+  typedef const T* const_iterator; /**< Const iterator type */
+
+  /** Constructs an empty list */
+  MoveList() : size_(0) { }
+
+  /**
+   * Copy constructor. Copies only the elements in use.
+   *
+   * @param other
+   */
+  MoveList(const MoveList& other) : size_(0)
+  {
+    for(const auto& e : other) {
+      push_back(e);
+    }
+  }
+
+  /**
+   * Copy assignment. Copies only the elements in use.
+   *
+   * @param other
+   *
+   * @return
+   */
+  MoveList& operator=(const MoveList& other)
+  {
+    if(this != &other) {
+      size_ = 0;
+      for(const auto& e : other) {
+	push_back(e);
+      }
+    }
+    return *this;
+  }
+
+  /**
+   * Construct a new element at the end of the list.
+   *
+   * @param args Arguments of the constructor of T
+   *
+   * @return The new element
+   */
+  template <typename... Args>
+  T& emplace_back(Args&&... args)
+  {
+    assert(size_ < N);
+    return *new (data() + size_++) T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * Append a copy of an element.
+   *
+   * @param e
+   */
+  void push_back(const T& e)
+  {
+    emplace_back(e);
+  }
+
+  /** Removes all elements */
+  void clear() { size_ = 0; }
+
+  /** @return The number of elements */
+  std::size_t size() const { return size_; }
+
+  /** @return True if there are no elements */
+  bool empty() const { return size_ == 0; }
+
+  /** @return The capacity N */
+  static constexpr std::size_t capacity() { return N; }
+
+  /** Element access */
+  T& operator[](std::size_t i) { assert(i < size_); return data()[i]; }
+
+  /** Element access */
+  const T& operator[](std::size_t i) const { assert(i < size_); return data()[i]; }
+
+  /** @return The first element */
+  T& front() { return (*this)[0]; }
+
+  /** @return The first element */
+  const T& front() const { return (*this)[0]; }
+
+  iterator begin() { return data(); } /**< Start of the elements */
+  iterator end() { return data() + size_; } /**< End of the elements */
+  const_iterator begin() const { return data(); } /**< Start of the elements */
+  const_iterator end() const { return data() + size_; } /**< End of the elements */
+
+private:
+
+  T* data() { return std::launder(reinterpret_cast<T*>(storage_)); }
+  const T* data() const { return std::launder(reinterpret_cast<const T*>(storage_)); }
+
+  alignas(T) unsigned char storage_[N * sizeof(T)]; /**< Raw storage for N elements */
+  std::size_t size_;				    /**< Number of elements in use */
+};
+
+#endif // MOVE_LIST_HPP
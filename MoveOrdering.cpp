@@ -0,0 +1,212 @@
+/**
+ * @file   MoveOrdering.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 15:40:02 2026
+ * 
+ * @brief  Move ordering implementation
+ * 
+ * 
+ */
+
+#include "MoveOrdering.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+/** 
+ * Constructor, with all heuristics on and empty tables. Registers the
+ * instance.
+ * 
+ */
+MoveOrdering::MoveOrdering()
+  : heuristics(ALL),
+    mobility_depth(DEFAULT_MOBILITY_DEPTH)
+{
+  clear();
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.instances.push_back(this);
+}
+
+/** 
+ * Destructor, at the exit of the thread. Keeps the counters for
+ * allStats().
+ * 
+ */
+MoveOrdering::~MoveOrdering()
+{
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.instances.erase(std::find(r.instances.begin(), r.instances.end(), this));
+  r.retired.nodes += stats_.nodes;
+  r.retired.cutoffs += stats_.cutoffs;
+  r.retired.firstMoveCutoffs += stats_.firstMoveCutoffs;
+}
+
+/** 
+ * @return The registry of the instances of all threads
+ */
+MoveOrdering::Registry& MoveOrdering::registry()
+{
+  static Registry r;
+  return r;
+}
+
+/** 
+ * The move ordering used by the search in this thread. Each thread
+ * searching in parallel learns its own killers and history.
+ * 
+ * @return 
+ */
+MoveOrdering& MoveOrdering::getInstance()
+{
+  static thread_local MoveOrdering ordering;
+  return ordering;
+}
+
+/** 
+ * Forget the killer moves, the history and the counters.
+ * 
+ */
+void MoveOrdering::clear()
+{
+  std::fill(&killers[0][0], &killers[0][0] + sizeof(killers), 0xff);
+  std::fill(&history[0][0], &history[0][0] + 2 * 64, 0);
+  resetStats();
+}
+
+/** 
+ * Forget the killer moves, the history and the counters of all
+ * threads, and those of the threads which have exited. No thread
+ * may be searching meanwhile.
+ * 
+ */
+void MoveOrdering::clearAll()
+{
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for(auto ordering : r.instances) {
+    ordering->clear();
+  }
+  r.retired = Stats();
+}
+
+/** 
+ * The counters summed over all threads, including those which have
+ * exited, since the last clearAll(). No thread may be searching
+ * meanwhile.
+ * 
+ * @return 
+ */
+MoveOrdering::Stats MoveOrdering::allStats()
+{
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  Stats sum = r.retired;
+  for(auto ordering : r.instances) {
+    sum.nodes += ordering->stats_.nodes;
+    sum.cutoffs += ordering->stats_.cutoffs;
+    sum.firstMoveCutoffs += ordering->stats_.firstMoveCutoffs;
+  }
+  return sum;
+}
+
+/** 
+ * The priority of a move; moves of higher score are searched first.
+ * 
+ * @param player The player making the move
+ * @param move Square of the move
+ * @param child The board after the move
+ * @param ply Ply of the node, i.e. its number of pieces
+ * @param depth Remaining depth of the node
+ * @param ttMove Best move stored in the transposition table, or 0xff
+ * 
+ * @return 
+ */
+int MoveOrdering::score(Board::Player player, uint8_t move, const Board& child,
+			int ply, int depth, uint8_t ttMove) const
+{
+  if( ( heuristics & TT_MOVE ) && move == ttMove ) {
+    return 1 << 30;
+  }
+  if( heuristics & KILLERS ) {
+    if( move == killers[ply][0] ) return ( 1 << 29 ) + 1;
+    if( move == killers[ply][1] ) return 1 << 29;
+  }
+  const int hist = ( heuristics & HISTORY ) ? std::min<uint32_t>(history[player][move], 0xffff) : 0;
+  if( ( heuristics & MOBILITY ) && depth <= mobility_depth ) {
+    const int replies = Board::popcount(child.legalMoves(~player));
+    return ( ( 64 - replies ) << 16 ) + hist;
+  }
+  return hist;
+}
+
+/** 
+ * Learn from a move that caused a cutoff.
+ * 
+ * @param player The player making the move
+ * @param move Square of the move
+ * @param ply Ply of the node
+ * @param depth Remaining depth of the node
+ * @param first Whether the move was the first one searched
+ */
+void MoveOrdering::cutoff(Board::Player player, uint8_t move, int ply, int depth, bool first)
+{
+  ++stats_.cutoffs;
+  if(first) {
+    ++stats_.firstMoveCutoffs;
+  }
+  if( killers[ply][0] != move ) {
+    killers[ply][1] = killers[ply][0];
+    killers[ply][0] = move;
+  }
+  history[player][move] += depth * depth;
+}
+
+/** 
+ * Print the cutoff counters of this thread.
+ * 
+ * @param s 
+ * 
+ * @return 
+ */
+std::ostream& MoveOrdering::printStats(std::ostream& s) const
+{
+  return print(s, stats_);
+}
+
+/** 
+ * Print the cutoff counters of all threads, see allStats().
+ * 
+ * @param s 
+ * 
+ * @return 
+ */
+std::ostream& MoveOrdering::printAllStats(std::ostream& s)
+{
+  return print(s, allStats());
+}
+
+/** 
+ * Print cutoff counters.
+ * 
+ * @param s 
+ * @param stats
+ * 
+ * @return 
+ */
+std::ostream& MoveOrdering::print(std::ostream& s, const Stats& stats)
+{
+  const auto percent = [](uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+  };
+  s << "Move ordering: nodes: " << stats.nodes
+    << ", cutoffs: " << stats.cutoffs
+    << " (" << std::fixed << std::setprecision(1) << percent(stats.cutoffs, stats.nodes) << "%)"
+    << ", on first move: " << stats.firstMoveCutoffs
+    << " (" << percent(stats.firstMoveCutoffs, stats.cutoffs) << "% of cutoffs)"
+    << std::defaultfloat << std::setprecision(6)
+    << std::endl;
+  return s;
+}
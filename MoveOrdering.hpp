@@ -0,0 +1,134 @@
+/**
+ * @file   MoveOrdering.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 15:12:30 2026
+ * 
+ * @brief  Heuristics ordering the moves searched by alpha-beta
+ * 
+ * Alpha-beta pruning cuts off most when the best move is searched
+ * first.
+ */
+
+#ifndef MOVE_ORDERING_HPP
+#define MOVE_ORDERING_HPP
+
+#include "Board.hpp"
+
+#include <cinttypes>
+#include <iosfwd>
+#include <vector>
+#include <mutex>
+
+/**
+ * Scores moves so that the moves most likely to cause a cutoff are
+ * searched first, and learns from the cutoffs. The stages, in order of
+ * priority, are
+ *
+ * -# the best move stored in the transposition table;
+ * -# the killer moves, the last two moves that caused a cutoff at
+ *    the same ply; the ply is the number of pieces on the board;
+ * -# the history table, crediting moves that cause cutoffs by
+ *    the square of the remaining depth;
+ * -# near the leaves, fastest-first: the moves leaving the opponent
+ *    the fewest replies are preferred to the history.
+ *
+ * Each stage can be turned off by clearing its bit in heuristics.
+ *
+ * Each thread has its own instance, see getInstance(). The instances
+ * of all threads are registered, so that clearAll() and allStats()
+ * reach the threads searching in parallel too; the counters of a
+ * thread which has exited are kept for allStats().
+ * 
+ */
+class MoveOrdering {
+public:
+
+  /**
+   * The stages of move ordering
+   * 
+   */
+  enum Heuristic {
+    TT_MOVE  = 1,		/**< Transposition table move first */
+    KILLERS  = 2,		/**< Killer moves next */
+    HISTORY  = 4,		/**< History table */
+    MOBILITY = 8,		/**< Fastest-first near the leaves */
+    ALL      = 15,		/**< All of the above */
+  };
+
+  static const int DEFAULT_MOBILITY_DEPTH = 3; /**< Fastest-first at this remaining depth or less */
+
+  /**
+   * Counters of the interior nodes searched with pruning
+   * 
+   */
+  struct Stats {
+    uint64_t nodes;		/**< Nodes whose children were ordered */
+    uint64_t cutoffs;		/**< Nodes cut off before searching all children */
+    uint64_t firstMoveCutoffs;	/**< Nodes cut off by the first child */
+  };
+
+  static MoveOrdering& getInstance();
+
+  static void clearAll();
+
+  static Stats allStats();
+
+  static std::ostream& printAllStats(std::ostream& s);
+
+  ~MoveOrdering();
+
+  unsigned heuristics;		/**< The stages in use, a mask of Heuristic */
+  int mobility_depth;		/**< Remaining depth at which fastest-first starts */
+
+  int score(Board::Player player, uint8_t move, const Board& child,
+	    int ply, int depth, uint8_t ttMove) const;
+
+  void cutoff(Board::Player player, uint8_t move, int ply, int depth, bool first);
+
+  /** 
+   * Count a node with ordered children.
+   */
+  void countNode() { ++stats_.nodes; }
+
+  void clear();
+
+  /** 
+   * @return The counters since the last resetStats()
+   */
+  const Stats& stats() const { return stats_; }
+
+  /** 
+   * Zero the counters.
+   */
+  void resetStats() { stats_ = Stats(); }
+
+  std::ostream& printStats(std::ostream& s) const;
+
+private:
+
+  /**
+   * The instances of all threads
+   * 
+   */
+  struct Registry {
+    std::mutex mutex;		/**< Lock of the registry */
+    std::vector<MoveOrdering*> instances; /**< The instances of the running threads */
+    Stats retired;		/**< Counters of the threads which have exited */
+  };
+
+  static Registry& registry();
+
+  static std::ostream& print(std::ostream& s, const Stats& stats);
+
+  static const int MAX_PLY = 65; /**< Number of pieces on the board is 0..64 */
+
+  MoveOrdering();
+  MoveOrdering(const MoveOrdering&) = delete;
+  MoveOrdering& operator=(const MoveOrdering&) = delete;
+
+  uint8_t killers[MAX_PLY][2];	/**< Two killer moves per ply */
+  uint32_t history[2][64];	/**< History score per player and square */
+  Stats stats_;			/**< Counters */
+};
+
+#endif	// MOVE_ORDERING_HPP
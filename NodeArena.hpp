@@ -0,0 +1,358 @@
+/**
+ * @file   NodeArena.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 17:02:18 2026
+ * 
+ * @brief  Allocator of the nodes of the game tree
+ * 
+ * The game tree has millions of small nodes, all of the same size.
+ * Allocating them one by one with malloc is slow and scatters them
+ * in memory.
+ */
+
+#ifndef NODE_ARENA_HPP
+#define NODE_ARENA_HPP
+
+#include <cinttypes>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include <array>
+#include <ostream>
+#include <cassert>
+#include <mutex>
+
+/**
+ * An allocator of objects of type T, carving them out of large slabs.
+ * Objects are allocated in blocks of adjacent objects, such as all
+ * children of a node. A released block is merged with the free blocks
+ * next to it in its slab and goes to a free list for its size, the
+ * last list holding all blocks larger than MAX_BLOCK. An allocation
+ * takes a free block of its size, or else splits the smallest larger
+ * one, so the memory of released blocks serves blocks of any size and
+ * the slabs hold little more than the live objects. Neither allocation
+ * nor release calls malloc or free, except to add a slab. The slabs
+ * themselves are released all at once by trim(), when no object is
+ * live.
+ *
+ * Allocation and release lock the arena, so that objects can be
+ * released by another thread. pointer() does not lock: the table of
+ * slabs is reserved in full up front and never moves.
+ * 
+ */
+template <typename T>
+class NodeArena {
+public:
+
+  /**
+   * Index of an object in the arena. Indices take half the memory of
+   * pointers.
+   * 
+   */
+  typedef uint32_t index_type;
+
+  static const int SLAB_BITS = 16;	   /**< Log2 of SLAB_SIZE */
+  static const size_t SLAB_SIZE = size_t(1) << SLAB_BITS; /**< Objects per slab */
+  static const size_t MAX_SLABS = size_t(1) << ( 32 - SLAB_BITS ); /**< Slabs addressable by index_type */
+  static const size_t MAX_BLOCK = 64;	   /**< Most objects allocated at once */
+  static const index_type NO_INDEX = ~index_type(0); /**< End of a free list */
+
+  /**
+   * Counters of arena use
+   * 
+   */
+  struct Stats {
+    uint64_t live;		/**< Objects allocated and not released */
+    uint64_t peak;		/**< Maximum of live */
+    uint64_t bytes;		/**< Memory held in slabs */
+  };
+
+  /** 
+   * @return The arena of all objects of type T
+   */
+  static NodeArena& getInstance()
+  {
+    static NodeArena arena;
+    return arena;
+  }
+
+  /** 
+   * Allocate memory for a block of objects, adjacent in memory.
+   * 
+   * @param n Number of objects, 1 to MAX_BLOCK
+   * 
+   * @return Index of uninitialized memory for n objects of type T
+   *
+   * @throw std::bad_alloc
+   */
+  index_type allocate(size_t n = 1)
+  {
+    assert(n >= 1 && n <= MAX_BLOCK);
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t k = n;
+    while( k <= MAX_BLOCK + 1 && free_[k] == NO_INDEX ) {
+      ++k;
+    }
+    index_type block;
+    if(k <= MAX_BLOCK + 1) {
+      block = free_[k];
+      const size_t m = slot(block)->free.size;
+      unlink(block);
+      mark(block, n, false);
+      // The rest of a larger block is left as a free block
+      if(m > n) {
+	push(block + n, m - n);
+      }
+    } else {
+      if(slabs_.empty() || used_ + n > SLAB_SIZE) {
+	if(slabs_.size() == MAX_SLABS) {
+	  throw std::bad_alloc();
+	}
+	// The rest of the last slab is left as a free block
+	if(used_ < SLAB_SIZE) {
+	  merge(first() + used_, SLAB_SIZE - used_);
+	}
+	slabs_.emplace_back(new Slot[SLAB_SIZE]);
+	free_bits_.resize(slabs_.size() * SLAB_SIZE / 64, 0);
+	used_ = 0;
+	stats_.bytes += SLAB_SIZE * sizeof(Slot);
+      }
+      block = first() + used_;
+      used_ += n;
+    }
+    if((stats_.live += n) > stats_.peak) {
+      stats_.peak = stats_.live;
+    }
+    return block;
+  }
+
+  /** 
+   * Return the memory of a block of objects, which must have been
+   * destroyed, to the arena.
+   * 
+   * @param index Index returned by allocate()
+   * @param n Number of objects passed to allocate()
+   */
+  void release(index_type index, size_t n = 1)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    merge(index, n);
+    stats_.live -= n;
+  }
+
+  /** 
+   * The memory of an allocated object. The objects of a block are
+   * adjacent: object index + i is at pointer(index) + i.
+   * 
+   * @param index 
+   * 
+   * @return 
+   */
+  T* pointer(index_type index) const
+  {
+    static_assert(sizeof(Slot) == sizeof(T), "Objects of a block are adjacent");
+    return std::launder(reinterpret_cast<T*>(slot(index)->object));
+  }
+
+  /** 
+   * Free all slabs if no object is live.
+   */
+  void trim()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(stats_.live == 0) {
+      slabs_.clear();
+      free_bits_.clear();
+      free_.fill(NO_INDEX);
+      used_ = SLAB_SIZE;
+      stats_.bytes = 0;
+    }
+  }
+
+  /** 
+   * @return The counters of arena use
+   */
+  Stats stats() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+  /** 
+   * Start counting the peak from now.
+   */
+  void resetPeak()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.peak = stats_.live;
+  }
+
+  /** 
+   * Print the counters.
+   * 
+   * @param s 
+   * 
+   * @return s
+   */
+  std::ostream& printStats(std::ostream& s) const
+  {
+    const Stats stats = this->stats();
+    s << "Node arena: " << ( stats.bytes >> 20 ) << " MB"
+      << ", live: " << stats.live
+      << ", peak: " << stats.peak
+      << ", node size: " << sizeof(T)
+      << std::endl;
+    return s;
+  }
+
+private:
+
+  /**
+   * Memory of one object, or the first or last slot of a free block
+   * 
+   */
+  union Slot {
+    struct {
+      index_type next;		/**< Next free block of the same list */
+      index_type prev;		/**< Previous free block of the same list */
+      index_type size;		/**< Slots of the block, in its first and last slot */
+    } free;
+    alignas(T) unsigned char object[sizeof(T)]; /**< Memory of the object */
+  };
+
+  /** 
+   * @param index 
+   * 
+   * @return The slot of an index
+   */
+  Slot* slot(index_type index) const
+  {
+    return &slabs_[index >> SLAB_BITS][index & ( SLAB_SIZE - 1 )];
+  }
+
+  /** 
+   * @return Index of the first slot of the last slab
+   */
+  index_type first() const
+  {
+    return index_type( ( slabs_.size() - 1 ) << SLAB_BITS );
+  }
+
+  /** 
+   * @param n Size of a free block
+   * 
+   * @return Its free list
+   */
+  static size_t list(size_t n)
+  {
+    return n <= MAX_BLOCK ? n : MAX_BLOCK + 1;
+  }
+
+  /** 
+   * @param index 
+   * 
+   * @return Whether the slot of an index is in a free block
+   */
+  bool isFree(index_type index) const
+  {
+    return ( free_bits_[index >> 6] >> ( index & 63 ) ) & 1;
+  }
+
+  /** 
+   * Mark the slots of a block as free or in use.
+   * 
+   * @param block 
+   * @param n Size of the block
+   * @param free True to mark them free
+   */
+  void mark(index_type block, size_t n, bool free)
+  {
+    for(size_t i = block; i < block + n; ++i) {
+      if(free) {
+	free_bits_[i >> 6] |= uint64_t(1) << ( i & 63 );
+      } else {
+	free_bits_[i >> 6] &= ~( uint64_t(1) << ( i & 63 ) );
+      }
+    }
+  }
+
+  /** 
+   * Add a block, whose slots are marked free, to the free list of its
+   * size.
+   * 
+   * @param block 
+   * @param n Size of the block
+   */
+  void push(index_type block, size_t n)
+  {
+    Slot* s = slot(block);
+    s->free.next = free_[list(n)];
+    s->free.prev = NO_INDEX;
+    s->free.size = n;
+    slot(block + n - 1)->free.size = n;
+    if(s->free.next != NO_INDEX) {
+      slot(s->free.next)->free.prev = block;
+    }
+    free_[list(n)] = block;
+  }
+
+  /** 
+   * Remove a block from its free list.
+   * 
+   * @param block 
+   */
+  void unlink(index_type block)
+  {
+    const Slot* s = slot(block);
+    if(s->free.prev != NO_INDEX) {
+      slot(s->free.prev)->free.next = s->free.next;
+    } else {
+      free_[list(s->free.size)] = s->free.next;
+    }
+    if(s->free.next != NO_INDEX) {
+      slot(s->free.next)->free.prev = s->free.prev;
+    }
+  }
+
+  /** 
+   * Free a block, merging it with the free blocks before and after it
+   * in its slab.
+   * 
+   * @param block 
+   * @param n Size of the block
+   */
+  void merge(index_type block, size_t n)
+  {
+    mark(block, n, true);
+    if( ( block & ( SLAB_SIZE - 1 ) ) != 0 && isFree(block - 1) ) {
+      const size_t before = slot(block - 1)->free.size;
+      block -= before;
+      n += before;
+      unlink(block);
+    }
+    const index_type after = block + n;
+    if( ( after & ( SLAB_SIZE - 1 ) ) != 0 && isFree(after) ) {
+      n += slot(after)->free.size;
+      unlink(after);
+    }
+    push(block, n);
+  }
+
+  NodeArena() : used_(SLAB_SIZE), stats_()
+  {
+    slabs_.reserve(MAX_SLABS);
+    free_.fill(NO_INDEX);
+  }
+  NodeArena(const NodeArena&) = delete;
+  NodeArena& operator=(const NodeArena&) = delete;
+
+  std::vector<std::unique_ptr<Slot[]>> slabs_; /**< All slabs, the last one being filled */
+  std::vector<uint64_t> free_bits_; /**< One bit per slot of the slabs, set if it is free */
+  std::array<index_type, MAX_BLOCK + 2> free_; /**< Free lists of released blocks, by size */
+  size_t used_;			/**< Slots in use in the last slab, SLAB_SIZE if none */
+  Stats stats_;			/**< Counters */
+  mutable std::mutex mutex_;	/**< Lock of all of the above but the slab contents */
+};
+
+#endif	// NODE_ARENA_HPP
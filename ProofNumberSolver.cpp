@@ -0,0 +1,233 @@
+/**
+ * @file   ProofNumberSolver.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 14:35:51 2026
+ *
+ * @brief  Depth-first proof-number search of the winner of a game, implementation
+ *
+ *
+ */
+
+#include "ProofNumberSolver.hpp"
+
+#include <iostream>
+#include <algorithm>
+
+/**
+ * Constructor.
+ *
+ * @param hash_mb The size of the table of proof and disproof numbers, in MB
+ * @param endgame_empties Goals with at most this many empty squares are
+ *        decided by the EndgameSolver
+ */
+ProofNumberSolver::ProofNumberSolver(size_t hash_mb, int endgame_empties)
+  : endgame_empties_(endgame_empties),
+    nodes_(0),
+    report_(nullptr),
+    interval_(std::chrono::seconds(60)),
+    start_(std::chrono::steady_clock::now()),
+    last_(start_)
+{
+  uint64_t buckets = 1;
+  while( 2 * buckets * WAYS * sizeof(Slot) <= hash_mb * 1024 * 1024 ) {
+    buckets *= 2;
+  }
+  table_.assign(buckets * WAYS, Slot{ 0, { 0, 0 }, 0 });
+  mask_ = buckets - 1;
+}
+
+/**
+ * The key of a goal in the table.
+ *
+ * @param board
+ * @param player The player to move
+ * @param threshold The goal is a score above it
+ *
+ * @return
+ */
+uint64_t ProofNumberSolver::key(const Board& board, BoardTraits::Player player, int threshold)
+{
+  return board.canonical().first.hash(player) ^ ( uint64_t(threshold + 128) * 0x9e3779b97f4a7c15UL );
+}
+
+/**
+ * Find the numbers of a goal in the table.
+ *
+ * @param key
+ * @param numbers Set to the numbers, if found
+ *
+ * @return True if found
+ */
+bool ProofNumberSolver::lookup(uint64_t key, Numbers& numbers) const
+{
+  const Slot* bucket = &table_[( key & mask_ ) * WAYS];
+  for(int i = 0; i < WAYS; ++i) {
+    if( bucket[i].work != 0 && bucket[i].key == key ) {
+      numbers = bucket[i].numbers;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Store the numbers of a goal in the table, in place of its previous
+ * numbers, or else of the goal of least work of the bucket.
+ *
+ * @param key
+ * @param numbers
+ * @param work The positions expanded to find the numbers
+ */
+void ProofNumberSolver::store(uint64_t key, Numbers numbers, uint64_t work)
+{
+  Slot* bucket = &table_[( key & mask_ ) * WAYS];
+  Slot* victim = bucket;
+  for(int i = 0; i < WAYS; ++i) {
+    if( bucket[i].work != 0 && bucket[i].key == key ) {
+      victim = &bucket[i];
+      break;
+    }
+    if( bucket[i].work < victim->work ) {
+      victim = &bucket[i];
+    }
+  }
+  *victim = Slot{ key, numbers, std::max<uint64_t>(work, 1) };
+}
+
+/**
+ * Report the progress, if the time since the last report is over.
+ *
+ */
+void ProofNumberSolver::progress()
+{
+  if(report_ == nullptr) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  if(now - last_ < interval_) {
+    return;
+  }
+  last_ = now;
+  const auto s = std::chrono::duration_cast<std::chrono::seconds>(now - start_).count();
+  *report_ << "[" << s << " s] nodes: " << nodes_
+	   << ", endgame nodes: " << endgame_.nodes()
+	   << " (" << ( nodes_ + endgame_.nodes() ) / std::max<int64_t>(s, 1) << "/s)"
+	   << std::endl;
+}
+
+/**
+ * Whether the player to move can finish with a score above a
+ * threshold.
+ *
+ * @param board
+ * @param player The player to move
+ * @param threshold
+ *
+ * @return True if the player scores more than threshold with perfect play
+ */
+bool ProofNumberSolver::proves(const Board& board, BoardTraits::Player player, int threshold)
+{
+  return mid(board, player, threshold, INF, INF).phi == 0;
+}
+
+/**
+ * The winner of a position, found by at most two proofs: that the
+ * player to move wins, and failing that, that it draws.
+ *
+ * @param board
+ * @param player The player to move
+ *
+ * @return 1 if WHITE wins with perfect play, 0 for a draw, -1 if BLACK
+ *         wins, i.e. the sign of the value of the position
+ */
+int ProofNumberSolver::wld(const Board& board, BoardTraits::Player player)
+{
+  const int sign = ( player == Board::WHITE ) ? 1 : -1;
+  if( proves(board, player, 0) ) {
+    return sign;
+  }
+  return proves(board, player, -1) ? 0 : -sign;
+}
+
+/**
+ * Multiple iterative deepening: expand the children of a position
+ * along the least disproof number of a child, i.e. the least proof
+ * number of the goal, until the numbers of the goal reach the
+ * thresholds. The goal of a child is the negation of the goal of its
+ * parent, that the opponent scores at least -threshold; in the
+ * notation of Nagai, phi of a position is the least delta of its
+ * children, and delta the sum of the phi of its children.
+ *
+ * @param board
+ * @param player The player to move
+ * @param threshold The goal is a score above it
+ * @param thphi Return once phi reaches it
+ * @param thdelta Return once delta reaches it
+ *
+ * @return The numbers of the goal
+ */
+ProofNumberSolver::Numbers
+ProofNumberSolver::mid(const Board& board, BoardTraits::Player player, int threshold,
+		       uint32_t thphi, uint32_t thdelta)
+{
+  ++nodes_;
+  progress();
+  const uint64_t nodes0 = nodes_, endgame0 = endgame_.nodes();
+  const uint64_t k = key(board, player, threshold);
+  const int empties = Board::w() * Board::h() - board.numTiles();
+  const uint64_t legal = board.legalMoves(player);
+  if( empties <= endgame_empties_ || ( legal == 0 && !board.hasLegalMove(~player) ) ) {
+    const int val = ( legal == 0 && !board.hasLegalMove(~player) ) ? board.score(player)
+      : endgame_.negamax(board, player, threshold, threshold + 1);
+    const Numbers numbers = ( val > threshold ) ? Numbers{ 0, INF } : Numbers{ INF, 0 };
+    store(k, numbers, endgame_.nodes() - endgame0);
+    return numbers;
+  }
+
+  // The children, with the opponent to move, after a move or a pass
+  Board children[Board::MAX_MOVES];
+  Numbers numbers[Board::MAX_MOVES];
+  int n = 0;
+  if(legal == 0) {
+    children[n++] = board;
+  }
+  for(uint64_t m = legal; m != 0; m &= m - 1) {
+    const uint8_t sq = Board::bitscan(m);
+    Board& child = children[n++];
+    child = board;
+    child.place(player, sq, board.flips(player, sq));
+  }
+  for(int i = 0; i < n; ++i) {
+    if( !lookup(key(children[i], ~player, -threshold - 1), numbers[i]) ) {
+      numbers[i] = { 1, std::max<uint32_t>(Board::popcount(children[i].legalMoves(~player)), 1) };
+    }
+  }
+
+  Numbers result;
+  while(true) {
+    uint32_t phi = INF, delta2 = INF;
+    uint64_t delta = 0;
+    int best = 0;
+    for(int i = 0; i < n; ++i) {
+      if(numbers[i].delta < phi) {
+	delta2 = phi;
+	phi = numbers[i].delta;
+	best = i;
+      } else if(numbers[i].delta < delta2) {
+	delta2 = numbers[i].delta;
+      }
+      if( delta != INF ) {
+	delta = ( numbers[i].phi == INF ) ? INF : std::min<uint64_t>(delta + numbers[i].phi, INF - 1);
+      }
+    }
+    result = { phi, uint32_t(delta) };
+    if( phi >= thphi || delta >= thdelta ) {
+      break;
+    }
+    const uint32_t childThphi = std::min<uint64_t>(uint64_t(thdelta) + numbers[best].phi - delta, INF);
+    const uint32_t childThdelta = std::min<uint64_t>(thphi, uint64_t(delta2) + 1);
+    numbers[best] = mid(children[best], ~player, -threshold - 1, childThphi, childThdelta);
+  }
+  store(k, result, nodes_ - nodes0 + 1 + endgame_.nodes() - endgame0);
+  return result;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file   ProofNumberSolver.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 14:32:09 2026
+ *
+ * @brief  Depth-first proof-number search of the winner of a game
+ *
+ * Used by the program othello_solve.
+ */
+
+#ifndef PROOF_NUMBER_SOLVER_HPP
+#define PROOF_NUMBER_SOLVER_HPP
+
+#include "Board.hpp"
+#include "EndgameSolver.hpp"
+#include "StaticEvaluator.hpp"
+
+#include <vector>
+#include <iosfwd>
+#include <chrono>
+#include <cinttypes>
+
+/**
+ * Finds whether a player wins, draws or loses a position with perfect
+ * play, without finding the score, by depth-first proof-number search
+ * (df-pn, Nagai 2002).
+ *
+ * A proof-number search proves or disproves a goal, here that the
+ * final score of the player to move is above a threshold. The proof
+ * number of a position is the least number of positions still to be
+ * solved to prove the goal, the disproof number to disprove it; the
+ * search always expands the most proving position, i.e. the one
+ * along the least numbers, so it visits a narrow tree where one side
+ * has many good moves. Best-first search keeps the whole tree in
+ * memory; df-pn finds the same positions depth first, keeping only
+ * the numbers, in a table of bounded size, and returns from a
+ * position once its numbers exceed thresholds set by its parent.
+ *
+ * Positions equal up to a symmetry share an entry of the table, see
+ * Board::canonical(). From endgame_empties empty squares on, the goal
+ * is decided by a null window search of the EndgameSolver.
+ *
+ */
+class ProofNumberSolver : public StaticEvaluatorTraits {
+public:
+  ProofNumberSolver(size_t hash_mb = 1024, int endgame_empties = 14);
+
+  bool proves(const Board& board, BoardTraits::Player player, int threshold);
+
+  int wld(const Board& board, BoardTraits::Player player);
+
+  /**
+   * Report the progress on a stream periodically.
+   *
+   * @param out
+   * @param seconds Time between reports
+   */
+  void reportTo(std::ostream& out, int seconds)
+  {
+    report_ = &out;
+    interval_ = std::chrono::seconds(seconds);
+  }
+
+  /**
+   * @return The number of positions expanded so far, not counting
+   *         those of the EndgameSolver
+   */
+  uint64_t nodes() const { return nodes_; }
+
+  /**
+   * @return The number of nodes visited by the EndgameSolver so far
+   */
+  uint64_t endgameNodes() const { return endgame_.nodes(); }
+
+private:
+
+  static constexpr uint32_t INF = 0x7fffffff; /**< A proof or disproof number of a solved goal */
+
+  /**
+   * The numbers of a goal, from the point of view of the player to
+   * move: phi is the proof number of the goal, delta its disproof
+   * number. Negating the goal for the opponent swaps them.
+   *
+   */
+  struct Numbers {
+    uint32_t phi;		/**< Positions to solve to achieve the goal */
+    uint32_t delta;		/**< Positions to solve to refute it */
+  };
+
+  /**
+   * An entry of the table.
+   *
+   */
+  struct Slot {
+    uint64_t key;		/**< Of the canonical board, the player and the threshold */
+    Numbers numbers;		/**< The numbers of the goal */
+    uint64_t work;		/**< Positions expanded to find them, or 0 if the slot is empty */
+  };
+
+  static constexpr int WAYS = 4;	/**< Slots of a bucket, the one of least work is replaced */
+
+  static uint64_t key(const Board& board, BoardTraits::Player player, int threshold);
+
+  bool lookup(uint64_t key, Numbers& numbers) const;
+
+  void store(uint64_t key, Numbers numbers, uint64_t work);
+
+  void progress();
+
+  Numbers mid(const Board& board, BoardTraits::Player player, int threshold,
+	      uint32_t thphi, uint32_t thdelta);
+
+  std::vector<Slot> table_;	/**< The table, in buckets of WAYS slots */
+  uint64_t mask_;		/**< Buckets minus one */
+  int endgame_empties_;		/**< Use the EndgameSolver with at most this many empty squares */
+  EndgameSolver endgame_;	/**< Solver of the last empty squares */
+  uint64_t nodes_;		/**< Node counter */
+  std::ostream* report_;	/**< Stream of progress reports, or nullptr */
+  std::chrono::steady_clock::duration interval_; /**< Time between progress reports */
+  std::chrono::steady_clock::time_point start_;  /**< Construction of the solver */
+  std::chrono::steady_clock::time_point last_;	 /**< Time of the last report */
+};
+
+#endif	// PROOF_NUMBER_SOLVER_HPP
@@ -0,0 +1,168 @@
+/**
+ * @file   Reclaimer.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 18:31:12 2026
+ * 
+ * @brief  Background deletion of game trees, implementation
+ * 
+ * 
+ */
+
+#include "Reclaimer.hpp"
+#include "NodeArena.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+bool Reclaimer::async = true;
+
+namespace {
+  /** 
+   * @return Monotonic time in nanoseconds
+   */
+  uint64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+      (std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+}
+
+/** 
+ * Constructor, starting the thread. The node arena is created first,
+ * so that it outlives the thread.
+ * 
+ */
+Reclaimer::Reclaimer()
+  : busy_(false),
+    stop_(false),
+    trees_(0),
+    foreground_ns_(0),
+    background_ns_(0)
+{
+  NodeArena<TreeNode>::getInstance();
+  thread_ = std::thread(&Reclaimer::run, this);
+}
+
+/** 
+ * Destructor. Deletes the remaining trees and stops the thread.
+ * 
+ */
+Reclaimer::~Reclaimer()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_.notify_one();
+  thread_.join();
+}
+
+/** 
+ * The reclaimer of all game trees.
+ * 
+ * @return 
+ */
+Reclaimer& Reclaimer::getInstance()
+{
+  static Reclaimer reclaimer;
+  return reclaimer;
+}
+
+/** 
+ * Take over a tree and delete it, in the background if async is set.
+ * 
+ * @param tree The tree, left empty
+ */
+void Reclaimer::discard(TreeNode&& tree)
+{
+  const auto start = now();
+  if(async) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.emplace_back(std::move(tree));
+    }
+    work_.notify_one();
+  } else {
+    {
+      TreeNode discarded(std::move(tree));
+    }
+    ++trees_;
+  }
+  foreground_ns_ += now() - start;
+}
+
+/** 
+ * Wait until all trees handed to discard() are deleted.
+ * 
+ */
+void Reclaimer::wait()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return queue_.empty() && !busy_; });
+}
+
+/** 
+ * The background thread: deletes the trees in the queue until stopped.
+ * 
+ */
+void Reclaimer::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  for(;;) {
+    work_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if(queue_.empty()) {	// and stop_
+      break;
+    }
+    TreeNode tree(std::move(queue_.front()));
+    queue_.pop_front();
+    busy_ = true;
+    lock.unlock();
+
+    const auto start = now();
+    tree = TreeNode();		// Deletes the descendents
+    background_ns_ += now() - start;
+    ++trees_;
+
+    lock.lock();
+    busy_ = false;
+    if(queue_.empty()) {
+      idle_.notify_all();
+    }
+  }
+}
+
+/** 
+ * @return The time spent deleting trees
+ */
+Reclaimer::Stats Reclaimer::stats() const
+{
+  return Stats{ trees_, foreground_ns_, background_ns_ };
+}
+
+/** 
+ * Reset the counters.
+ */
+void Reclaimer::resetStats()
+{
+  trees_ = 0;
+  foreground_ns_ = 0;
+  background_ns_ = 0;
+}
+
+/** 
+ * Print the counters.
+ * 
+ * @param s 
+ * 
+ * @return s
+ */
+std::ostream& Reclaimer::printStats(std::ostream& s) const
+{
+  s << "Tree deletion: " << trees_ << " trees"
+    << ", on the move path: " << std::fixed << std::setprecision(3) << foreground_ns_ * 1e-6 << " ms"
+    << ", in the background: " << background_ns_ * 1e-6 << " ms"
+    << std::defaultfloat << std::setprecision(6)
+    << std::endl;
+  return s;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file   Reclaimer.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 18:20:37 2026
+ * 
+ * @brief  Deletion of discarded game trees in the background
+ * 
+ * After each move, the tree below the old root, but for the subtree
+ * of the move played, is discarded. Deleting a deep tree takes time
+ * that the next search could use.
+ */
+
+#ifndef RECLAIMER_HPP
+#define RECLAIMER_HPP
+
+#include "TreeNode.hpp"
+
+#include <cinttypes>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <iosfwd>
+
+/**
+ * A thread deleting the trees handed to it by discard(). The memory
+ * of the nodes goes back to the node arena, which is thread safe, so
+ * the game goes on while the old tree is deleted.
+ *
+ * The time spent deleting trees is measured both in the background
+ * and, when discard() deletes synchronously, on the move path.
+ * 
+ */
+class Reclaimer {
+public:
+
+  static bool async;		/**< Delete in the background, or in discard() */
+
+  /**
+   * Time spent deleting trees, in nanoseconds
+   * 
+   */
+  struct Stats {
+    uint64_t trees;		/**< Trees deleted */
+    uint64_t foreground_ns;	/**< Time in discard(), on the move path */
+    uint64_t background_ns;	/**< Time deleting in the background thread */
+  };
+
+  static Reclaimer& getInstance();
+
+  void discard(TreeNode&& tree);
+  void wait();
+
+  Stats stats() const;
+  void resetStats();
+  std::ostream& printStats(std::ostream& s) const;
+
+private:
+
+  Reclaimer();
+  ~Reclaimer();
+  Reclaimer(const Reclaimer&) = delete;
+  Reclaimer& operator=(const Reclaimer&) = delete;
+
+  void run();
+
+  std::deque<TreeNode> queue_;	/**< Trees to delete */
+  bool busy_;			/**< A tree is being deleted */
+  bool stop_;			/**< The thread should exit */
+  mutable std::mutex mutex_;	/**< Lock of the above */
+  std::condition_variable work_; /**< Signals a new tree or stop_ */
+  std::condition_variable idle_; /**< Signals that all trees are deleted */
+  std::atomic<uint64_t> trees_;	 /**< Trees deleted */
+  std::atomic<uint64_t> foreground_ns_; /**< See Stats */
+  std::atomic<uint64_t> background_ns_; /**< See Stats */
+  std::thread thread_;		/**< The background thread, started last */
+};
+
+#endif	// RECLAIMER_HPP
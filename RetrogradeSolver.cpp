@@ -0,0 +1,454 @@
+/**
+ * @file   RetrogradeSolver.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 13:07:40 2026
+ *
+ * @brief  Solver of a whole game by layers of positions on disk, implementation
+ *
+ *
+ */
+
+#include "RetrogradeSolver.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <queue>
+#include <tuple>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+  /**
+   * Read a record of a binary file.
+   *
+   * @param in
+   * @param r Set to the record
+   *
+   * @return True unless the file is at its end
+   */
+  template<class Record>
+  inline bool read(std::istream& in, Record& r)
+  {
+    return bool(in.read(reinterpret_cast<char*>(&r), sizeof(r)));
+  }
+
+  /**
+   * Write a record to a binary file.
+   *
+   * @param out
+   * @param r
+   */
+  template<class Record>
+  inline void write(std::ostream& out, const Record& r)
+  {
+    out.write(reinterpret_cast<const char*>(&r), sizeof(r));
+  }
+
+  /**
+   * Sorts records in a file, in runs that fit in memory merged at the
+   * end.
+   *
+   */
+  template<class Record, class Less>
+  class ExternalSort {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param path The file of the sorted records
+     * @param bytes The memory of a run
+     * @param less The order
+     */
+    ExternalSort(const std::string& path, size_t bytes, Less less)
+      : path_(path),
+	capacity_(std::max<size_t>(bytes / sizeof(Record), 1)),
+	less_(less)
+    {
+      buffer_.reserve(capacity_);
+    }
+
+    /**
+     * Add a record.
+     *
+     * @param r
+     */
+    void add(const Record& r)
+    {
+      buffer_.push_back(r);
+      if(buffer_.size() == capacity_) {
+	flush(run(runs_++));
+      }
+    }
+
+    /**
+     * Write the file of the sorted records.
+     *
+     * @param unique If true, only the first of equal records is kept
+     *
+     * @return The number of records of the file
+     */
+    uint64_t finish(bool unique)
+    {
+      if(runs_ == 0) {
+	return flush(path_, unique);
+      }
+      flush(run(runs_++));
+      int first = 0;		// The runs not merged yet
+      while(runs_ - first > FAN_IN) {
+	const int last = runs_;
+	for(int i = first; i < last; i += FAN_IN) {
+	  merge(i, std::min(i + FAN_IN, last), run(runs_++), false);
+	}
+	first = last;
+      }
+      return merge(first, runs_, path_, unique);
+    }
+
+  private:
+    static const int FAN_IN = 64; /**< Runs merged at once, each an open file */
+
+    /**
+     * Merge runs into a file, and remove them.
+     *
+     * @param begin The first run
+     * @param end Past the last run
+     * @param path
+     * @param unique If true, only the first of equal records is kept
+     *
+     * @return The number of records written
+     */
+    uint64_t merge(int begin, int end, const std::string& path, bool unique)
+    {
+      std::vector<std::ifstream> in;
+      for(int i = begin; i < end; ++i) {
+	in.emplace_back(run(i), std::ios::binary);
+      }
+      // The least record first
+      auto greater = [this](const std::pair<Record, int>& a, const std::pair<Record, int>& b) {
+	return less_(b.first, a.first);
+      };
+      std::priority_queue<std::pair<Record, int>, std::vector<std::pair<Record, int>>,
+			  decltype(greater)> heads(greater);
+      Record r;
+      for(size_t i = 0; i < in.size(); ++i) {
+	if(read(in[i], r)) {
+	  heads.emplace(r, i);
+	}
+      }
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      uint64_t count = 0;
+      Record last{};
+      while(!heads.empty()) {
+	const auto [head, i] = heads.top();
+	heads.pop();
+	if( !unique || count == 0 || less_(last, head) ) {
+	  write(out, head);
+	  last = head;
+	  ++count;
+	}
+	if(read(in[i], r)) {
+	  heads.emplace(r, i);
+	}
+      }
+      check(out);
+      for(int i = begin; i < end; ++i) {
+	in[i - begin].close();
+	std::filesystem::remove(run(i));
+      }
+      return count;
+    }
+
+    std::string run(int i) const { return path_ + ".run" + std::to_string(i); }
+
+    /**
+     * Sort the records in memory and write them to a file.
+     *
+     * @param path
+     * @param unique If true, only the first of equal records is kept
+     *
+     * @return The number of records written
+     */
+    uint64_t flush(const std::string& path, bool unique = false)
+    {
+      std::sort(buffer_.begin(), buffer_.end(), less_);
+      if(unique) {
+	auto equal = [this](const Record& a, const Record& b) { return !less_(a, b); };
+	buffer_.erase(std::unique(buffer_.begin(), buffer_.end(), equal), buffer_.end());
+      }
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      out.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size() * sizeof(Record));
+      check(out);
+      const uint64_t count = buffer_.size();
+      buffer_.clear();
+      return count;
+    }
+
+    void check(const std::ostream& out) const
+    {
+      if(!out) {
+	throw std::runtime_error(path_ + ": cannot write");
+      }
+    }
+
+    std::string path_;		/**< The file of the sorted records */
+    size_t capacity_;		/**< Records of a run */
+    Less less_;			/**< The order */
+    std::vector<Record> buffer_; /**< The records of the current run */
+    int runs_ = 0;		/**< Runs written so far */
+  };
+
+  /**
+   * The order of positions in a layer.
+   *
+   * @param r A State
+   *
+   * @return The key of the order
+   */
+  template<class Record>
+  inline auto key(const Record& r)
+  {
+    return std::tie(r.filled, r.white, r.player);
+  }
+}
+
+/**
+ * Constructor.
+ *
+ * @param dir The directory of the files of the layers, created if needed
+ * @param sort_mb The memory of a sort, in MB
+ */
+RetrogradeSolver::RetrogradeSolver(const std::string& dir, size_t sort_mb)
+  : dir_(dir),
+    sort_bytes_(sort_mb * 1024 * 1024),
+    report_(nullptr)
+{
+}
+
+/**
+ * The file of a layer. Its name has the board size, so that the
+ * layers of different boards may share a directory; so do the names
+ * of the temporary files of a layer, which start with it.
+ *
+ * @param tiles The number of pieces of the layer
+ *
+ * @return The path of the file
+ */
+std::string RetrogradeSolver::path(int tiles) const
+{
+  return dir_ + "/" + std::to_string(Board::w()) + "x" + std::to_string(Board::h())
+    + "_layer_" + std::to_string(tiles) + ".dat";
+}
+
+/**
+ * The record of a position in a layer.
+ *
+ * @param board
+ * @param player The player to move
+ *
+ * @return The record, and the sign of the value of the position
+ *         relative to the value of the record: -1 if the player to
+ *         move has changed, by a pass or at the end of the game
+ */
+std::pair<RetrogradeSolver::State, int>
+RetrogradeSolver::normalize(const Board& board, BoardTraits::Player player)
+{
+  const Board canon = board.canonical().first;
+  int sign = 1;
+  if( board.legalMoves(player) == 0 ) {
+    // A pass, or the end of the game with WHITE to move
+    if( board.legalMoves(~player) != 0 || player == Board::WHITE ) {
+      player = ~player;
+      sign = -1;
+    }
+  }
+  return { State{ canon.filledSquares(), canon.whiteSquares(), uint8_t(player), 0, { 0 } }, sign };
+}
+
+/**
+ * Write the next layer: the positions after the moves from those of a
+ * layer.
+ *
+ * @param tiles The number of pieces of the layer
+ *
+ * @return The number of positions of the next layer
+ */
+uint64_t RetrogradeSolver::enumerate(int tiles)
+{
+  auto less = [](const State& a, const State& b) { return key(a) < key(b); };
+  ExternalSort<State, decltype(less)> next(path(tiles + 1), sort_bytes_, less);
+  std::ifstream in(path(tiles), std::ios::binary);
+  State s;
+  while(read(in, s)) {
+    const Board board(s.filled, s.white);
+    const auto player = BoardTraits::Player(s.player);
+    for(uint64_t m = board.legalMoves(player); m != 0; m &= m - 1) {
+      const uint8_t sq = Board::bitscan(m);
+      Board child(board);
+      child.place(player, sq, board.flips(player, sq));
+      next.add(normalize(child, ~player).first);
+    }
+  }
+  return next.finish(true);
+}
+
+/**
+ * Find the values of the positions of a layer from those of the next
+ * one, which must be known.
+ *
+ * @param tiles The number of pieces of the layer
+ */
+void RetrogradeSolver::propagate(int tiles)
+{
+  const std::string layer = path(tiles), solved = layer + ".new";
+  const std::string requests = layer + ".requests", replies = layer + ".replies";
+
+  // The moves, by the position after the move
+  {
+    auto less = [](const Request& a, const Request& b) { return key(a.child) < key(b.child); };
+    ExternalSort<Request, decltype(less)> sorted(requests, sort_bytes_, less);
+    std::ifstream in(layer, std::ios::binary);
+    State s;
+    for(uint64_t i = 0; read(in, s); ++i) {
+      const Board board(s.filled, s.white);
+      const auto player = BoardTraits::Player(s.player);
+      for(uint64_t m = board.legalMoves(player); m != 0; m &= m - 1) {
+	const uint8_t sq = Board::bitscan(m);
+	Board child(board);
+	child.place(player, sq, board.flips(player, sq));
+	auto [state, sign] = normalize(child, ~player);
+	state.value = sign;
+	sorted.add(Request{ state, i });
+      }
+    }
+    sorted.finish(false);
+  }
+
+  // Their values, by the position before the move
+  {
+    auto less = [](const Reply& a, const Reply& b) { return a.parent < b.parent; };
+    ExternalSort<Reply, decltype(less)> sorted(replies, sort_bytes_, less);
+    std::ifstream in(requests, std::ios::binary), next(path(tiles + 1), std::ios::binary);
+    Request r;
+    State s;
+    bool more = read(next, s);
+    while(read(in, r)) {
+      while( more && key(s) < key(r.child) ) {
+	more = read(next, s);
+      }
+      if( !more || key(s) != key(r.child) ) {
+	throw std::runtime_error(path(tiles + 1) + ": a position is missing");
+      }
+      sorted.add(Reply{ r.parent, int8_t(-r.child.value * s.value), { 0 } });
+    }
+    sorted.finish(false);
+  }
+
+  // The best move of each position, or the final score
+  {
+    std::ifstream in(layer, std::ios::binary), values(replies, std::ios::binary);
+    std::ofstream out(solved, std::ios::binary | std::ios::trunc);
+    State s;
+    Reply r;
+    bool pending = read(values, r);
+    for(uint64_t i = 0; read(in, s); ++i) {
+      const Board board(s.filled, s.white);
+      const auto player = BoardTraits::Player(s.player);
+      if( board.legalMoves(player) == 0 ) {
+	s.value = board.score(player);
+      } else {
+	int best = -65;
+	for(/* Empty */; pending && r.parent == i; pending = read(values, r)) {
+	  best = std::max<int>(best, r.value);
+	}
+	s.value = best;
+      }
+      write(out, s);
+    }
+    if(!out) {
+      throw std::runtime_error(solved + ": cannot write");
+    }
+  }
+  std::filesystem::rename(solved, layer);
+  std::filesystem::remove(requests);
+  std::filesystem::remove(replies);
+}
+
+/**
+ * Enumerate the layers from the initial position, then find the
+ * values of all their positions. The files of the layers are kept.
+ *
+ * @return The value of the initial position, for WHITE
+ *
+ * @throw std::runtime_error if a file cannot be written
+ */
+StaticEvaluatorTraits::value_type RetrogradeSolver::solve()
+{
+  std::filesystem::create_directories(dir_);
+  const auto start = std::chrono::steady_clock::now();
+  auto elapsed = [&start]() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  const Board initial;
+  const int first = initial.numTiles(), last = Board::w() * Board::h();
+  positions_.assign(last + 1, 0);
+  {
+    std::ofstream out(path(first), std::ios::binary | std::ios::trunc);
+    write(out, normalize(initial, Board::BLACK).first);
+  }
+  positions_[first] = 1;
+  for(int tiles = first; tiles < last && positions_[tiles] > 0; ++tiles) {
+    positions_[tiles + 1] = enumerate(tiles);
+    if(report_) {
+      *report_ << "[" << elapsed() << " s] layer " << tiles + 1 << ": "
+	       << positions_[tiles + 1] << " positions" << std::endl;
+    }
+  }
+  for(int tiles = last; tiles >= first; --tiles) {
+    if(positions_[tiles] == 0) {
+      continue;
+    }
+    propagate(tiles);
+    if(report_) {
+      *report_ << "[" << elapsed() << " s] layer " << tiles << " solved" << std::endl;
+    }
+  }
+  return value(initial, Board::BLACK);
+}
+
+/**
+ * The value of a position, looked up in its layer, by binary search
+ * in the file.
+ *
+ * @param board
+ * @param player The player to move
+ *
+ * @return The final score with perfect play, i.e. the value for WHITE
+ *
+ * @throw std::out_of_range if the position is not reachable from the
+ *        initial position, or the layers are not solved
+ */
+StaticEvaluatorTraits::value_type
+RetrogradeSolver::value(const Board& board, BoardTraits::Player player) const
+{
+  const auto [target, sign] = normalize(board, player);
+  std::ifstream in(path(board.numTiles()), std::ios::binary | std::ios::ate);
+  uint64_t lo = 0, hi = in ? uint64_t(in.tellg()) / sizeof(State) : 0;
+  while(lo < hi) {
+    const uint64_t mid = lo + ( hi - lo ) / 2;
+    State s;
+    in.seekg(mid * sizeof(State));
+    read(in, s);
+    if( key(s) < key(target) ) {
+      lo = mid + 1;
+    } else if( key(target) < key(s) ) {
+      hi = mid;
+    } else {
+      const int val = sign * s.value;
+      return ( player == Board::WHITE ) ? val : -val;
+    }
+  }
+  throw std::out_of_range("RetrogradeSolver::value: not a position of the layers");
+}
@@ -0,0 +1,120 @@
+/**
+ * @file   RetrogradeSolver.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 13:05:12 2026
+ *
+ * @brief  Solver of a whole game by layers of positions on disk
+ *
+ * Used by the program othello_solve.
+ */
+
+#ifndef RETROGRADE_SOLVER_HPP
+#define RETROGRADE_SOLVER_HPP
+
+#include "Board.hpp"
+#include "StaticEvaluator.hpp"
+
+#include <string>
+#include <iosfwd>
+#include <utility>
+#include <vector>
+#include <cinttypes>
+
+/**
+ * Finds the value of every position reachable from the initial
+ * position, i.e. a strong solution of the game, in memory bounded by
+ * a parameter and disk proportional to the number of positions.
+ *
+ * Every move adds one piece, so the number of pieces splits the
+ * positions into layers, and the moves only lead from a layer to the
+ * next. The solver first enumerates the layers forward: the positions
+ * of a layer are the moves from those of the previous one, sorted and
+ * without duplicates, in a file. Then it finds the values backward,
+ * from the full board: the moves from a layer are sorted by position
+ * and merged with the next layer, which is sorted the same way, and
+ * the values of the moves are sorted back by the position they are
+ * from. All sorts are external, in runs of at most sort_mb megabytes.
+ *
+ * The positions are reduced by symmetry, see Board::canonical(),
+ * and a player without a move is replaced by the opponent, so a layer
+ * has no passes. When the game is over the player is BLACK.
+ *
+ */
+class RetrogradeSolver : public StaticEvaluatorTraits {
+public:
+  RetrogradeSolver(const std::string& dir = ".", size_t sort_mb = 256);
+
+  value_type solve();
+
+  value_type value(const Board& board, BoardTraits::Player player) const;
+
+  /**
+   * Report the size of each layer on a stream.
+   *
+   * @param out
+   */
+  void reportTo(std::ostream& out) { report_ = &out; }
+
+  /**
+   * Set the memory of a sort in bytes, for runs of fewer records than
+   * a megabyte holds.
+   *
+   * @param bytes
+   */
+  void setSortBytes(size_t bytes) { sort_bytes_ = bytes; }
+
+  /**
+   * @param tiles The number of pieces on the board
+   *
+   * @return The number of positions of the layer, after solve()
+   */
+  uint64_t positions(int tiles) const { return tiles < int(positions_.size()) ? positions_[tiles] : 0; }
+
+private:
+
+  /**
+   * A record of a layer: a position and its value.
+   *
+   */
+  struct State {
+    uint64_t filled;		/**< Board::filledSquares() of the canonical board */
+    uint64_t white;		/**< Board::whiteSquares() of the canonical board */
+    uint8_t player;		/**< The player to move */
+    int8_t value;		/**< The value for the player to move, once known */
+    uint8_t unused[6];		/**< Zero */
+  };
+
+  /**
+   * A move from a position of a layer, to be looked up in the next.
+   *
+   */
+  struct Request {
+    State child;		/**< The position after the move, with the sign of its value in value */
+    uint64_t parent;		/**< The index of the position in its layer */
+  };
+
+  /**
+   * The value of a move, for the player to move before it.
+   *
+   */
+  struct Reply {
+    uint64_t parent;		/**< The index of the position in its layer */
+    int8_t value;		/**< The value of the move */
+    uint8_t unused[7];		/**< Zero */
+  };
+
+  static std::pair<State, int> normalize(const Board& board, BoardTraits::Player player);
+
+  std::string path(int tiles) const;
+
+  uint64_t enumerate(int tiles);
+
+  void propagate(int tiles);
+
+  std::string dir_;		/**< Directory of the files */
+  size_t sort_bytes_;		/**< Memory of a sort, in bytes */
+  std::vector<uint64_t> positions_; /**< Positions of each layer */
+  std::ostream* report_;	/**< Stream of progress reports, or nullptr */
+};
+
+#endif	// RETROGRADE_SOLVER_HPP
@@ -0,0 +1,207 @@
+/**
+ * @file   Search.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 11:20:03 2026
+ * 
+ * @brief  Alpha-beta search on the stack, implementation
+ * 
+ * 
+ */
+
+#include "Search.hpp"
+#include "Deadline.hpp"
+#include "TranspositionTable.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+/** 
+ * Constructor.
+ * 
+ * @param evaluator Static evaluator, computing values for WHITE
+ * @param prune If true, do alpha-beta pruning, else plain minmax
+ */
+Search::Search(const StaticEvaluator& evaluator, bool prune)
+  : evaluator(evaluator),
+    prune(prune),
+    nodes_(0),
+    stop_(nullptr)
+{
+}
+
+/** 
+ * The static value of a board from the point of view of the player
+ * to move. The evaluator scores boards for WHITE.
+ * 
+ * @param board 
+ * @param player 
+ * @param depth 
+ * 
+ * @return 
+ */
+inline int Search::evaluate(const Board& board, BoardTraits::Player player, int depth) const
+{
+  const int val = evaluator(board, player, depth);
+  return ( player == Board::WHITE ) ? val : -val;
+}
+
+/** 
+ * Fail-soft negamax with alpha-beta pruning, when pruning is on.
+ * The value is from the point of view of the player to move.
+ * 
+ * @param board 
+ * @param player The player to move
+ * @param depth Remaining depth
+ * @param alpha Most the player to move can already achieve
+ * @param beta  Least the opponent can already hold the player to
+ * 
+ * @return The value of the board
+ *
+ * @throw Deadline::Expired
+ * @throw Stopped
+ */
+int Search::negamax(const Board& board, BoardTraits::Player player, int depth, int alpha, int beta)
+{
+  ++nodes_;
+  Deadline::check();
+  if( stop_ != nullptr && stop_->load(std::memory_order_relaxed) ) {
+    throw Stopped();
+  }
+  const uint64_t legal = board.legalMoves(player);
+  if( depth <= 0 || ( legal == 0 && !board.hasLegalMove(~player) ) ) {
+    return evaluate(board, player, depth);
+  }
+
+  // The table holds values and bounds for WHITE
+  const bool white = ( player == Board::WHITE );
+  auto& table = TranspositionTable::getInstance();
+  const uint64_t key = TranspositionTable::key(board.hash(player), evaluator);
+  TranspositionTable::Entry entry;
+  uint8_t ttMove = TranspositionTable::NO_MOVE;
+  if( table.probe(key, entry) ) {
+    if( entry.depth == depth ) {
+      const int val = white ? entry.value : -entry.value;
+      const auto lower = white ? TranspositionTable::LOWER : TranspositionTable::UPPER;
+      const auto upper = white ? TranspositionTable::UPPER : TranspositionTable::LOWER;
+      if( entry.bound == TranspositionTable::EXACT
+	  || ( entry.bound == lower && val >= beta )
+	  || ( entry.bound == upper && val <= alpha ) ) {
+	table.countCutoff();
+	return val;
+      }
+    }
+    ttMove = entry.move;
+  }
+
+  const int alpha0 = alpha;
+  int bestVal = -INF;
+  uint8_t bestMove = TranspositionTable::NO_MOVE;
+  if( legal == 0 ) {		// Pass
+    bestVal = -negamax(board, ~player, depth - 1, -beta, -alpha);
+  } else {
+    // The move of the table first, then in the order of squares
+    uint64_t rest = legal;
+    uint8_t sq = ( ttMove != TranspositionTable::NO_MOVE && ( legal & ( uint64_t(1) << ttMove ) ) )
+      ? ttMove : Board::bitscan(legal);
+    for(;;) {
+      rest &= ~( uint64_t(1) << sq );
+      Board child(board);
+      child.play(player, sq);
+      const int val = -negamax(child, ~player, depth - 1, -beta, -alpha);
+      if( val > bestVal ) {
+	bestVal = val;
+	bestMove = sq;
+      }
+      if(prune) {
+	alpha = std::max(alpha, bestVal);
+	if(alpha >= beta) {
+	  break;
+	}
+      }
+      if(rest == 0) {
+	break;
+      }
+      sq = Board::bitscan(rest);
+    }
+  }
+
+  const auto bound = ( bestVal <= alpha0 ) ? ( white ? TranspositionTable::UPPER : TranspositionTable::LOWER )
+    : ( bestVal >= beta ) ? ( white ? TranspositionTable::LOWER : TranspositionTable::UPPER )
+    : TranspositionTable::EXACT;
+  table.store(key, white ? bestVal : -bestVal, bound, depth, bestMove);
+  return bestVal;
+}
+
+/** 
+ * The value of a board to given depth.
+ * 
+ * @param board 
+ * @param player The player to move
+ * @param depth 
+ * 
+ * @return The value for WHITE, as computed by TreeNode::alphabeta()
+ */
+StaticEvaluatorTraits::value_type
+Search::value(const Board& board, BoardTraits::Player player, int depth)
+{
+  const int val = negamax(board, player, depth, -INF, INF);
+  return ( player == Board::WHITE ) ? val : -val;
+}
+
+/** 
+ * The value of a board to given depth, searched with a window, like
+ * TreeNode::alphabeta(). A value outside the window is a bound.
+ * 
+ * @param board 
+ * @param player The player to move
+ * @param depth 
+ * @param alpha The window, for WHITE
+ * @param beta 
+ * 
+ * @return The value for WHITE, or a bound on it: at most alpha, or
+ *         at least beta
+ */
+StaticEvaluatorTraits::value_type
+Search::value(const Board& board, BoardTraits::Player player, int depth,
+	      value_type alpha, value_type beta)
+{
+  if( player == Board::WHITE ) {
+    return negamax(board, player, depth, alpha, beta);
+  }
+  return -negamax(board, player, depth, -beta, -alpha);
+}
+
+/** 
+ * Finds all best moves of a player. With pruning each move is
+ * searched with a window just below the best value found so far, so
+ * that moves tying with the best one are recognized as such.
+ * 
+ * @param board 
+ * @param player The player to move
+ * @param depth Search depth, at least 1
+ * 
+ * @return The squares of all moves of the highest value, or an
+ *         empty list if the player must pass.
+ */
+Search::squares_type
+Search::bestMoves(const Board& board, BoardTraits::Player player, int depth)
+{
+  assert(depth >= 1);
+  squares_type best;
+  int bestVal = -INF;
+  for(auto m = board.legalMoves(player); m != 0; m &= m - 1) {
+    const uint8_t sq = Board::bitscan(m);
+    Board child(board);
+    child.play(player, sq);
+    const int alpha = prune ? std::max(bestVal - 1, -INF) : -INF;
+    const int val = -negamax(child, ~player, depth - 1, -INF, -alpha);
+    if(val > bestVal) {
+      bestVal = val;
+      best.clear();
+    }
+    if(val == bestVal) {
+      best.push_back(sq);
+    }
+  }
+  return best;
+}
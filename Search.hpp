@@ -0,0 +1,84 @@
+/**
+ * @file   Search.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 11:05:40 2026
+ * 
+ * @brief  Alpha-beta search on the stack
+ * 
+ * Searches Board values directly, with no game tree in memory.
+ */
+
+#ifndef SEARCH_HPP
+#define SEARCH_HPP
+
+#include "Board.hpp"
+#include "StaticEvaluator.hpp"
+
+#include <cinttypes>
+#include <atomic>
+
+/**
+ * Negamax search with optional alpha-beta pruning.
+ *
+ * Each ply copies the 16-byte Board and applies a move with
+ * Board::play(), so the only memory used is the call stack, one frame
+ * per ply. The values are identical to those computed by
+ * TreeNode::alphabeta() for the same evaluator, depth and pruning
+ * flag: a node is evaluated statically when the depth is exhausted or
+ * when neither player can move, and a player with no move passes to
+ * the opponent, which costs one ply.
+ *
+ * Like TreeNode::alphabeta(), the search caches values in the
+ * TranspositionTable, which the two searches share.
+ * 
+ */
+class Search : public StaticEvaluatorTraits {
+public:
+  /**
+   * A list of squares, see Board::square()
+   * 
+   */
+  typedef MoveList<uint8_t, Board::MAX_MOVES> squares_type;
+
+  Search(const StaticEvaluator& evaluator, bool prune = true);
+
+  value_type value(const Board& board, BoardTraits::Player player, int depth);
+
+  value_type value(const Board& board, BoardTraits::Player player, int depth,
+		   value_type alpha, value_type beta);
+
+  squares_type bestMoves(const Board& board, BoardTraits::Player player, int depth);
+
+  /** 
+   * @return The number of nodes visited so far.
+   */
+  uint64_t nodes() const { return nodes_; }
+
+  /**
+   * Thrown by a search stopped by stopOn()
+   * 
+   */
+  struct Stopped { };
+
+  /** 
+   * Stop searching, by throwing Stopped, once a flag is set.
+   * 
+   * @param stop The flag, checked at every node
+   */
+  void stopOn(const std::atomic<bool>& stop) { stop_ = &stop; }
+
+private:
+
+  static const int INF = MAX_VAL + 1; /**< Above any value of the evaluator */
+
+  int negamax(const Board& board, BoardTraits::Player player, int depth, int alpha, int beta);
+
+  int evaluate(const Board& board, BoardTraits::Player player, int depth) const;
+
+  const StaticEvaluator& evaluator; /**< Static evaluator for the leaves */
+  bool prune;			    /**< Use alpha-beta pruning if true */
+  uint64_t nodes_;		    /**< Node counter */
+  const std::atomic<bool>* stop_;   /**< See stopOn() */
+};
+
+#endif	// SEARCH_HPP
@@ -0,0 +1,49 @@
+/**
+ * @file   SearchTraits.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 11:02:17 2026
+ * 
+ * @brief  Properties of the search shared by the game tree and the main loop
+ * 
+ * 
+ */
+
+#ifndef SEARCH_TRAITS_HPP
+#define SEARCH_TRAITS_HPP
+
+/**
+ * Properties of the search shared by the game tree and the main loop
+ * 
+ */
+struct SearchTraits {
+  /**
+   * The implementation used by the computer to search for its move.
+   * 
+   */
+  enum Backend {
+    TREE  = 0,		/**< Build the game tree of TreeNode objects */
+    STACK = 1,		/**< Search on Board values on the stack, see Search */
+  };
+
+  /**
+   * How several threads share the search.
+   * 
+   */
+  enum Parallel {
+    ROOT_SPLIT = 0,	/**< Each thread searches whole children of the root */
+    YBWC       = 1,	/**< Young Brothers Wait: split any node after its eldest child */
+    LAZY_SMP   = 2,	/**< Threads search the whole root, sharing the TranspositionTable */
+  };
+
+  /**
+   * The algorithm of the search with pruning.
+   * 
+   */
+  enum Algorithm {
+    ALPHABETA = 0,	/**< Alpha-beta, searching every child with the window of the node */
+    PVS       = 1,	/**< Principal Variation Search, with aspiration windows at the root */
+    MTDF      = 2,	/**< MTD(f), a series of searches with a null window at the root */
+  };
+};
+
+#endif
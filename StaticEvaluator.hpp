@@ -16,6 +16,7 @@
 
 #include <limits>
 #include <cinttypes>
+#include <atomic>
 
 /**
  * Provides some traits for all static evaluators
@@ -63,6 +64,19 @@ class Board;
  */
 struct StaticEvaluator {
 
+  /** 
+   * Constructor. Assigns a new id.
+   * 
+   */
+  StaticEvaluator() : id(next_id++) { }
+
+  /**
+   * Unique among the evaluators constructed by the program, so that
+   * values cached for one evaluator are not used for another one.
+   * Copies share the id, as they compute the same values.
+   */
+  const uint64_t id;
+
   /** 
    * @param b
    * @param player
@@ -71,6 +85,9 @@ struct StaticEvaluator {
    * @return 
    */
   virtual StaticEvaluatorTraits::value_type operator()(const Board& b, BoardTraits::Player player, int depth) const = 0;
+
+private:
+  static inline std::atomic<uint64_t> next_id = 1; /**< Id of the next evaluator */
 };
 
 /**
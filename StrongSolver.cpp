@@ -0,0 +1,414 @@
+/**
+ * @file   StrongSolver.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 11:04:18 2026
+ *
+ * @brief  Solver of a whole game, in bounded memory, implementation
+ *
+ *
+ */
+
+#include "StrongSolver.hpp"
+#include "TranspositionTable.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <cassert>
+
+const SimpleStaticEvaluator StrongSolver::scoreKey;
+
+const char StrongSolver::MAGIC[8] = { 'O', 'T', 'H', 'S', 'O', 'L', 'V', '2' };
+
+/**
+ * Constructor. Opens the file of bounds, or creates it.
+ *
+ * @param path The file of bounds, or an empty string for none
+ * @param spill_empties Positions with at least this many empty squares go to the file
+ * @param endgame_empties Positions with at most this many are solved by the EndgameSolver
+ *
+ * @throw std::runtime_error if the file is not a file of bounds of
+ *        the current board size, or cannot be written
+ */
+StrongSolver::StrongSolver(const std::string& path, int spill_empties, int endgame_empties)
+  : path_(path),
+    slots_(0),
+    spill_empties_(spill_empties),
+    endgame_empties_(endgame_empties),
+    stored_(0),
+    solved_(0),
+    nodes_(0),
+    report_(nullptr),
+    interval_(std::chrono::seconds(60))
+{
+  if(!path_.empty()) {
+    load();
+  }
+}
+
+/**
+ * Open the file of bounds and count its positions, or create it. The
+ * file is a record with MAGIC and the board size, followed by the
+ * slots of the hash table, a record each; an empty slot is zero.
+ *
+ * @throw std::runtime_error
+ */
+void StrongSolver::load()
+{
+  std::ifstream in(path_, std::ios::binary);
+  if( !in || in.peek() == std::ifstream::traits_type::eof() ) {
+    create(path_, MIN_SLOTS);
+    return;
+  }
+  char header[sizeof(Record)];
+  const uint64_t size = std::filesystem::file_size(path_);
+  slots_ = size / sizeof(Record) - 1;
+  if( !in.read(header, sizeof(header)) || !std::equal(MAGIC, MAGIC + sizeof(MAGIC), header)
+      || header[sizeof(MAGIC)] != Board::w() || header[sizeof(MAGIC) + 1] != Board::h()
+      || size % sizeof(Record) != 0 || slots_ == 0 || ( slots_ & ( slots_ - 1 ) ) != 0 ) {
+    throw std::runtime_error(path_ + ": not a file of positions of this board size");
+  }
+  Record r;
+  while( in.read(reinterpret_cast<char*>(&r), sizeof(r)) ) {
+    stored_ += ( r.filled != 0 );
+    solved_ += ( r.filled != 0 && r.bounds.lower == r.bounds.upper );
+  }
+  in.close();
+  file_.open(path_, std::ios::binary | std::ios::in | std::ios::out);
+  if(!file_) {
+    throw std::runtime_error(path_ + ": cannot open for writing");
+  }
+}
+
+/**
+ * Create a file of bounds with empty slots, and open it as the file.
+ *
+ * @param path
+ * @param slots The number of slots, a power of 2
+ *
+ * @throw std::runtime_error
+ */
+void StrongSolver::create(const std::string& path, uint64_t slots)
+{
+  static_assert(sizeof(Record) == 24, "Records of the file are 24 bytes");
+  char header[sizeof(Record)] = { 0 };
+  std::copy(MAGIC, MAGIC + sizeof(MAGIC), header);
+  header[sizeof(MAGIC)] = char(Board::w());
+  header[sizeof(MAGIC) + 1] = char(Board::h());
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if( !out.write(header, sizeof(header)) ) {
+      throw std::runtime_error(path + ": cannot write");
+    }
+  }
+  std::filesystem::resize_file(path, ( slots + 1 ) * sizeof(Record));
+  file_.open(path, std::ios::binary | std::ios::in | std::ios::out);
+  if(!file_) {
+    throw std::runtime_error(path + ": cannot open for writing");
+  }
+  slots_ = slots;
+}
+
+/**
+ * Find the slot of a position in the file, by linear probing from
+ * the hash of the position.
+ *
+ * @param canonical The board, see Board::canonical()
+ * @param player The player to move
+ * @param r Set to the record of the position, or to an empty record
+ *
+ * @return The slot of the position, or the empty slot where it goes
+ *
+ * @throw std::runtime_error
+ */
+uint64_t StrongSolver::find(const Board& canonical, BoardTraits::Player player, Record& r)
+{
+  for(uint64_t slot = canonical.hash(player) & ( slots_ - 1 ); ; slot = ( slot + 1 ) & ( slots_ - 1 )) {
+    const auto it = pending_.find(slot);
+    if(it != pending_.end()) {
+      r = it->second;
+    } else {
+      file_.seekg(( slot + 1 ) * sizeof(Record));
+      if( !file_.read(reinterpret_cast<char*>(&r), sizeof(r)) ) {
+	throw std::runtime_error(path_ + ": cannot read");
+      }
+    }
+    if( r.filled == 0
+	|| ( r.filled == canonical.filledSquares() && r.white == canonical.whiteSquares()
+	     && r.player == player ) ) {
+      return slot;
+    }
+  }
+}
+
+/**
+ * Write a record to a slot of the file, in the next batch.
+ *
+ * @param slot
+ * @param r
+ *
+ * @throw std::runtime_error
+ */
+void StrongSolver::write(uint64_t slot, const Record& r)
+{
+  pending_[slot] = r;
+  if(pending_.size() >= BATCH) {
+    flush();
+  }
+}
+
+/**
+ * Write the pending records to the file.
+ *
+ * @throw std::runtime_error
+ */
+void StrongSolver::flush()
+{
+  for(const auto& [slot, r] : pending_) {
+    file_.seekp(( slot + 1 ) * sizeof(Record));
+    file_.write(reinterpret_cast<const char*>(&r), sizeof(r));
+  }
+  pending_.clear();
+  if( !file_.flush() ) {
+    throw std::runtime_error(path_ + ": cannot write");
+  }
+}
+
+/**
+ * Double the slots of the file: the records are moved to a new file,
+ * which then replaces the file, so a computation stopped meanwhile
+ * loses nothing.
+ *
+ * @throw std::runtime_error
+ */
+void StrongSolver::grow()
+{
+  flush();
+  std::fstream old;
+  old.swap(file_);
+  const uint64_t slots = slots_;
+  const std::string next = path_ + ".next";
+  create(next, 2 * slots);
+  old.seekg(sizeof(Record));
+  Record r, found;
+  for(uint64_t i = 0; i < slots; ++i) {
+    if( !old.read(reinterpret_cast<char*>(&r), sizeof(r)) ) {
+      throw std::runtime_error(path_ + ": cannot read");
+    }
+    if(r.filled != 0) {
+      write(find(Board(r.filled, r.white), BoardTraits::Player(r.player), found), r);
+    }
+  }
+  flush();
+  old.close();
+  file_.close();
+  std::filesystem::rename(next, path_);
+  file_.open(path_, std::ios::binary | std::ios::in | std::ios::out);
+  if(!file_) {
+    throw std::runtime_error(path_ + ": cannot open for writing");
+  }
+}
+
+/**
+ * Add bounds of a position to the file. The file is doubled when
+ * half full, so that the probes stay short.
+ *
+ * @param canonical The board, see Board::canonical()
+ * @param player The player to move
+ * @param bounds Bounds on the value for the player to move
+ *
+ * @throw std::runtime_error
+ */
+void StrongSolver::spill(const Board& canonical, BoardTraits::Player player, Bounds bounds)
+{
+  Record r;
+  const uint64_t slot = find(canonical, player, r);
+  if(r.filled == 0) {
+    r = Record{ canonical.filledSquares(), canonical.whiteSquares(), uint8_t(player),
+		Bounds{ -INF, INF }, { 0 } };
+    ++stored_;
+  }
+  const bool exact = ( r.bounds.lower == r.bounds.upper );
+  r.bounds.lower = std::max(r.bounds.lower, bounds.lower);
+  r.bounds.upper = std::min(r.bounds.upper, bounds.upper);
+  solved_ += ( !exact && r.bounds.lower == r.bounds.upper );
+  write(slot, r);
+  if( 2 * stored_ > slots_ ) {
+    grow();
+  }
+}
+
+/**
+ * Report the progress, if the time since the last report is over,
+ * and write the pending records to the file.
+ *
+ */
+void StrongSolver::progress()
+{
+  if(report_ == nullptr) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  if(now - last_ < interval_) {
+    return;
+  }
+  last_ = now;
+  if(file_.is_open()) {
+    flush();
+  }
+  const auto s = std::chrono::duration_cast<std::chrono::seconds>(now - start_).count();
+  *report_ << "[" << s << " s] nodes: " << nodes_
+	   << ", endgame nodes: " << endgame_.nodes()
+	   << " (" << ( nodes_ + endgame_.nodes() ) / std::max<int64_t>(s, 1) << "/s)"
+	   << ", stored positions: " << stored_
+	   << ", solved positions: " << solved_
+	   << std::endl;
+}
+
+/**
+ * The value of a position.
+ *
+ * @param board
+ * @param player The player to move
+ *
+ * @return The final score with perfect play, i.e. the value for WHITE
+ */
+StaticEvaluatorTraits::value_type
+StrongSolver::solve(const Board& board, BoardTraits::Player player)
+{
+  start_ = last_ = std::chrono::steady_clock::now();
+  const int empties = Board::w() * Board::h() - board.numTiles();
+  const int val = negamax(board, player, empties, -INF, INF, false);
+  if(file_.is_open()) {
+    flush();
+  }
+  return ( player == Board::WHITE ) ? val : -val;
+}
+
+/**
+ * Fail-soft alpha-beta search to the end of the game, in negamax
+ * form, like EndgameSolver::solve(). Moves are searched fastest first,
+ * after the move of the table. The table is probed and stored by the
+ * hash of the canonical board, and its move is a square of the
+ * canonical board.
+ *
+ * @param board
+ * @param player The player to move
+ * @param empties The number of empty squares
+ * @param alpha
+ * @param beta
+ * @param passed True if the opponent has just passed
+ *
+ * @return The final score for the player to move
+ */
+int StrongSolver::negamax(const Board& board, BoardTraits::Player player, int empties,
+			  int alpha, int beta, bool passed)
+{
+  if(empties <= endgame_empties_) {
+    return endgame_.negamax(board, player, alpha, beta);
+  }
+
+  ++nodes_;
+  progress();
+  const uint64_t legal = board.legalMoves(player);
+  if(legal == 0) {
+    if(passed) {		// Neither player can move
+      return board.score(player);
+    }
+    return -negamax(board, ~player, empties, -beta, -alpha, true);
+  }
+
+  const auto [canon, t] = board.canonical();
+  const uint64_t hash = canon.hash(player);
+  const bool spilled = ( !path_.empty() && empties >= spill_empties_ );
+  if(spilled) {
+    Record r;
+    find(canon, player, r);
+    if(r.filled != 0) {
+      const Bounds bounds = r.bounds;
+      if( bounds.lower == bounds.upper || bounds.lower >= beta ) {
+	return bounds.lower;
+      } else if( bounds.upper <= alpha ) {
+	return bounds.upper;
+      }
+    }
+  }
+
+  // The table holds values and bounds for WHITE, see Search
+  const bool white = ( player == Board::WHITE );
+  auto& table = TranspositionTable::getInstance();
+  const uint64_t key = TranspositionTable::key(hash, scoreKey);
+  uint8_t ttMove = TranspositionTable::NO_MOVE;
+  TranspositionTable::Entry entry;
+  if( table.probe(key, entry) ) {
+    if( entry.depth == empties ) {
+      const int val = white ? entry.value : -entry.value;
+      const auto lower = white ? TranspositionTable::LOWER : TranspositionTable::UPPER;
+      const auto upper = white ? TranspositionTable::UPPER : TranspositionTable::LOWER;
+      if( entry.bound == TranspositionTable::EXACT
+	  || ( entry.bound == lower && val >= beta )
+	  || ( entry.bound == upper && val <= alpha ) ) {
+	table.countCutoff();
+	return val;
+      }
+    }
+    if( entry.move != TranspositionTable::NO_MOVE ) {
+      ttMove = Board::transform(entry.move, Board::inverse(t));
+    }
+  }
+
+  // Fastest first: fewest replies
+  uint8_t squares[Board::MAX_MOVES];
+  uint64_t flips[Board::MAX_MOVES];
+  int order[Board::MAX_MOVES];
+  int n = 0;
+  for(uint64_t m = legal; m != 0; m &= m - 1) {
+    const uint8_t sq = Board::bitscan(m);
+    const uint64_t f = board.flips(player, sq);
+    Board child(board);
+    child.place(player, sq, f);
+    const int o = ( sq == ttMove ) ? -1 : Board::popcount(child.legalMoves(~player));
+    int j = n++;
+    for(/* Empty */; j > 0 && order[j-1] > o; --j) {
+      order[j] = order[j-1];
+      squares[j] = squares[j-1];
+      flips[j] = flips[j-1];
+    }
+    order[j] = o;
+    squares[j] = sq;
+    flips[j] = f;
+  }
+
+  const int alpha0 = alpha;
+  int bestVal = -INF;
+  uint8_t bestMove = TranspositionTable::NO_MOVE;
+  for(int i = 0; i < n; ++i) {
+    Board child(board);
+    child.place(player, squares[i], flips[i]);
+    const int val = -negamax(child, ~player, empties - 1, -beta, -alpha, false);
+    if(val > bestVal) {
+      bestVal = val;
+      bestMove = squares[i];
+      alpha = std::max(alpha, bestVal);
+      if(alpha >= beta) {
+	break;
+      }
+    }
+  }
+
+  const auto bound = ( bestVal <= alpha0 ) ? ( white ? TranspositionTable::UPPER : TranspositionTable::LOWER )
+    : ( bestVal >= beta ) ? ( white ? TranspositionTable::LOWER : TranspositionTable::UPPER )
+    : TranspositionTable::EXACT;
+  table.store(key, white ? bestVal : -bestVal, bound, empties, Board::transform(bestMove, t));
+  if(spilled) {
+    Bounds bounds = { int8_t(bestVal), int8_t(bestVal) };
+    if(bestVal <= alpha0) {
+      bounds.lower = -INF;
+    } else if(bestVal >= beta) {
+      bounds.upper = INF;
+    }
+    spill(canon, player, bounds);
+  }
+  return bestVal;
+}
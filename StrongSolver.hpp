@@ -0,0 +1,153 @@
+/**
+ * @file   StrongSolver.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 11:02:36 2026
+ *
+ * @brief  Solver of a whole game, in bounded memory
+ *
+ * Used by the program othello_solve.
+ */
+
+#ifndef STRONG_SOLVER_HPP
+#define STRONG_SOLVER_HPP
+
+#include "Board.hpp"
+#include "EndgameSolver.hpp"
+#include "StaticEvaluator.hpp"
+#include "SimpleStaticEvaluator.hpp"
+
+#include <string>
+#include <fstream>
+#include <iosfwd>
+#include <unordered_map>
+#include <chrono>
+#include <cinttypes>
+
+/**
+ * Finds the game-theoretic value, the final score with perfect play,
+ * of a position far from the end of the game, e.g. of the initial
+ * position of the 6x6 board.
+ *
+ * Unlike TreeNode::minmax(), the solver keeps no tree: it searches
+ * depth first with alpha-beta pruning, so the memory it needs is
+ * bounded by the size of the TranspositionTable. Positions equal up
+ * to a symmetry of the board are one entry of the table, see
+ * Board::canonical(). From endgame_empties empty squares on, the position is
+ * handed to the EndgameSolver.
+ *
+ * The bounds found for positions with at least spill_empties empty
+ * squares, i.e. near the root, are also kept in a file: a hash table
+ * on disk, with open addressing, which is doubled when half full.
+ * The solver looks the positions up in the file, so its memory does
+ * not grow with their number, and writes them in batches. The file
+ * stays, so a computation of days can be stopped and resumed, and
+ * those positions survive the replacement of entries in the table.
+ *
+ */
+class StrongSolver : public StaticEvaluatorTraits {
+public:
+  StrongSolver(const std::string& path = "", int spill_empties = 20, int endgame_empties = 14);
+
+  value_type solve(const Board& board, BoardTraits::Player player);
+
+  /**
+   * Report the progress on a stream periodically.
+   *
+   * @param out
+   * @param seconds Time between reports
+   */
+  void reportTo(std::ostream& out, int seconds)
+  {
+    report_ = &out;
+    interval_ = std::chrono::seconds(seconds);
+  }
+
+  /**
+   * @return The number of nodes visited so far, not counting those
+   *         of the EndgameSolver
+   */
+  uint64_t nodes() const { return nodes_; }
+
+  /**
+   * @return The number of nodes visited by the EndgameSolver so far
+   */
+  uint64_t endgameNodes() const { return endgame_.nodes(); }
+
+  /**
+   * @return The number of positions of the file with an exact value
+   */
+  uint64_t solved() const { return solved_; }
+
+  /**
+   * @return The number of positions of the file
+   */
+  uint64_t stored() const { return stored_; }
+
+private:
+
+  static const int INF = 65;	/**< Above any score */
+
+  static const SimpleStaticEvaluator scoreKey; /**< Its id keys the table entries of the solver */
+
+  /**
+   * Bounds on the value of a position, for the player to move
+   *
+   */
+  struct Bounds {
+    int8_t lower;		/**< The value is at least */
+    int8_t upper;		/**< The value is at most */
+  };
+
+  /**
+   * A record of the file: the bounds of a position.
+   *
+   */
+  struct Record {
+    uint64_t filled;		/**< Board::filledSquares() of the canonical board */
+    uint64_t white;		/**< Board::whiteSquares() of the canonical board */
+    uint8_t player;		/**< The player to move */
+    Bounds bounds;		/**< Bounds on the value */
+    uint8_t unused[5];		/**< Zero */
+  };
+
+  static const char MAGIC[8];	/**< First bytes of the file */
+
+  static const uint64_t MIN_SLOTS = 1 << 10; /**< Slots of a new file */
+  static const size_t BATCH = 4096; /**< Records written to the file at once */
+
+  void load();
+
+  void create(const std::string& path, uint64_t slots);
+
+  uint64_t find(const Board& canonical, BoardTraits::Player player, Record& r);
+
+  void write(uint64_t slot, const Record& r);
+
+  void flush();
+
+  void grow();
+
+  void spill(const Board& canonical, BoardTraits::Player player, Bounds bounds);
+
+  void progress();
+
+  int negamax(const Board& board, BoardTraits::Player player, int empties,
+	      int alpha, int beta, bool passed);
+
+  std::string path_;		/**< The file, or empty for none */
+  std::fstream file_;		/**< The file, open for reading and writing */
+  uint64_t slots_;		/**< Records of the file, a power of 2 */
+  std::unordered_map<uint64_t, Record> pending_; /**< Records not written yet, by slot */
+  int spill_empties_;		/**< Store positions with at least this many empty squares */
+  int endgame_empties_;		/**< Use the EndgameSolver with at most this many */
+  uint64_t stored_;		/**< Positions of the file */
+  uint64_t solved_;		/**< Positions of the file with an exact value */
+  EndgameSolver endgame_;	/**< Solver of the last empty squares */
+  uint64_t nodes_;		/**< Node counter */
+  std::ostream* report_;	/**< Stream of progress reports, or nullptr */
+  std::chrono::steady_clock::duration interval_; /**< Time between progress reports */
+  std::chrono::steady_clock::time_point start_;  /**< Start of solve() */
+  std::chrono::steady_clock::time_point last_;	 /**< Time of the last report */
+};
+
+#endif	// STRONG_SOLVER_HPP
@@ -0,0 +1,170 @@
+/**
+ * @file   TranspositionTable.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 13:58:44 2026
+ * 
+ * @brief  Transposition table implementation
+ * 
+ * 
+ */
+
+#include "TranspositionTable.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+/** 
+ * Constructor of the table of default size.
+ * 
+ */
+TranspositionTable::TranspositionTable()
+  : buckets(),
+    mask(0),
+    stats_()
+{
+  resize(DEFAULT_SIZE_MB);
+}
+
+/** 
+ * The table shared by all searches.
+ * 
+ * @return 
+ */
+TranspositionTable& TranspositionTable::getInstance()
+{
+  static TranspositionTable table;
+  return table;
+}
+
+/** 
+ * Resize the table and clear it. The number of buckets is the
+ * largest power of 2 that fits in the given size.
+ * 
+ * @param megabytes Size in megabytes; 0 disables the table
+ *
+ * @throw std::bad_alloc
+ */
+void TranspositionTable::resize(size_t megabytes)
+{
+  size_t count = ( megabytes << 20 ) / sizeof(Bucket);
+  while( count & ( count - 1 ) ) {
+    count &= count - 1;		// Keep the highest bit
+  }
+  std::vector<Bucket>().swap(buckets);
+  buckets.resize(count);
+  mask = count ? count - 1 : 0;
+  clear();
+}
+
+/** 
+ * Remove all entries and zero the counters.
+ * 
+ */
+void TranspositionTable::clear()
+{
+  std::fill(buckets.begin(), buckets.end(), Bucket());
+  resetStats();
+}
+
+/** 
+ * Store the result of a search, see the replacement policy in the
+ * class description.
+ * 
+ * @param key See key()
+ * @param value Value for WHITE
+ * @param bound 
+ * @param depth Depth of the search
+ * @param move Best move found, or NO_MOVE
+ */
+void TranspositionTable::store(uint64_t key, value_type value, Bound bound, int depth, uint8_t move)
+{
+  if( buckets.empty() ) return;
+  counters().stores.fetch_add(1, std::memory_order_relaxed);
+  const uint64_t data = pack(Entry {
+      .value = value,
+      .bound = bound,
+      .depth = static_cast<uint8_t>(std::clamp(depth, 0, 255)),
+      .move  = move,
+    });
+  Bucket& b = buckets[key & mask];
+  uint64_t keys[DEPTH_SLOTS + 1], datas[DEPTH_SLOTS + 1];
+  for(int i = 0; i <= DEPTH_SLOTS; ++i) {
+    read(b.slot[i], keys[i], datas[i]);
+  }
+  // The same position is simply updated
+  for(int i = 0; i <= DEPTH_SLOTS; ++i) {
+    if( keys[i] == key ) {
+      write(b.slot[i], key, data);
+      return;
+    }
+  }
+  // The shallowest depth-preferred entry, empty ones first
+  int shallowest = 0, minDepth = 256;
+  for(int i = 0; i < DEPTH_SLOTS; ++i) {
+    const int d = ( datas[i] == 0 ) ? -1 : unpack(datas[i]).depth;
+    if( d < minDepth ) {
+      shallowest = i;
+      minDepth = d;
+    }
+  }
+  if( depth >= minDepth ) {
+    if( datas[shallowest] != 0 ) {
+      write(b.slot[DEPTH_SLOTS], keys[shallowest], datas[shallowest]);
+    }
+    write(b.slot[shallowest], key, data);
+  } else {
+    write(b.slot[DEPTH_SLOTS], key, data);
+  }
+}
+
+/** 
+ * @return The counters of all threads since the last resetStats()
+ */
+TranspositionTable::Stats TranspositionTable::stats() const
+{
+  Stats s{ 0, 0, 0, 0 };
+  for(const auto& c : stats_) {
+    s.probes += c.probes;
+    s.hits += c.hits;
+    s.cutoffs += c.cutoffs;
+    s.stores += c.stores;
+  }
+  return s;
+}
+
+/** 
+ * Zero the counters.
+ * 
+ */
+void TranspositionTable::resetStats()
+{
+  for(auto& c : stats_) {
+    c.probes = c.hits = c.cutoffs = c.stores = 0;
+  }
+}
+
+/** 
+ * Print the table size and usage counters.
+ * 
+ * @param s 
+ * 
+ * @return 
+ */
+std::ostream& TranspositionTable::printStats(std::ostream& s) const
+{
+  const auto percent = [](uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+  };
+  const Stats stats = this->stats();
+  s << "Transposition table: " << ( bytes() >> 20 ) << " MB"
+    << ", probes: " << stats.probes
+    << ", hits: " << stats.hits
+    << " (" << std::fixed << std::setprecision(1) << percent(stats.hits, stats.probes) << "%)"
+    << ", cutoffs: " << stats.cutoffs
+    << " (" << percent(stats.cutoffs, stats.probes) << "%)"
+    << ", stores: " << stats.stores
+    << std::defaultfloat << std::setprecision(6)
+    << std::endl;
+  return s;
+}
@@ -0,0 +1,276 @@
+/**
+ * @file   TranspositionTable.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 13:31:09 2026
+ * 
+ * @brief  A fixed size table of search results
+ * 
+ * Caches the values of positions found by alpha-beta search, so that
+ * positions reached by different move orders are searched once.
+ */
+
+#ifndef TRANSPOSITION_TABLE_HPP
+#define TRANSPOSITION_TABLE_HPP
+
+#include "Board.hpp"
+#include "StaticEvaluator.hpp"
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+#include <atomic>
+#include <iosfwd>
+
+/**
+ * A hash table of search results of fixed size, organized in buckets
+ * of one cache line (64 bytes). An entry stores the value of a
+ * position, whether the value is exact or a bound, the depth of the
+ * search and the best move.
+ *
+ * Replacement policy: the first DEPTH_SLOTS entries of a bucket keep
+ * the deepest results; a new result replaces the shallowest of them if
+ * it is at least as deep, and the entry it displaces moves to the last
+ * entry of the bucket. Otherwise it goes to the last entry, which is
+ * always replaced. Deep results, which are expensive, thus survive,
+ * while recent shallow results are still cached.
+ *
+ * Probes and stores may run in several threads, without locks: the
+ * two words of an entry are read and written atomically one by one,
+ * and an entry whose words come from different stores fails to verify
+ * against its key, see Slot.
+ * 
+ */
+class TranspositionTable : public StaticEvaluatorTraits {
+public:
+
+  /**
+   * What the stored value tells about the true value
+   * 
+   */
+  enum Bound : uint8_t {
+    NONE  = 0,			/**< Empty entry */
+    UPPER = 1,			/**< True value <= value (search failed low) */
+    LOWER = 2,			/**< True value >= value (search failed high) */
+    EXACT = 3,			/**< True value == value */
+  };
+
+  static const uint8_t NO_MOVE = 0xff; /**< Best move of a node that passes */
+  static const int DEFAULT_SIZE_MB = 64; /**< Default table size in megabytes */
+
+  /**
+   * The unpacked contents of an entry
+   * 
+   */
+  struct Entry {
+    value_type value;		/**< Value for WHITE */
+    Bound bound;		/**< Kind of value */
+    uint8_t depth;		/**< Depth of the search */
+    uint8_t move;		/**< Square of the best move, or NO_MOVE */
+  };
+
+  /**
+   * Counters of table use
+   * 
+   */
+  struct Stats {
+    uint64_t probes;		/**< Number of lookups */
+    uint64_t hits;		/**< Lookups that found the position */
+    uint64_t cutoffs;		/**< Hits whose value ended the search of the node */
+    uint64_t stores;		/**< Number of stored results */
+  };
+
+  static TranspositionTable& getInstance();
+
+  void resize(size_t megabytes);
+  void clear();
+
+  /** 
+   * @return The size of the table in bytes
+   */
+  size_t bytes() const { return buckets.size() * sizeof(Bucket); }
+
+  static uint64_t key(uint64_t hash, const StaticEvaluator& evaluator);
+
+  bool probe(uint64_t key, Entry& entry);
+  void store(uint64_t key, value_type value, Bound bound, int depth, uint8_t move);
+
+  /** 
+   * Count a hit that ended the search of a node.
+   */
+  void countCutoff() { counters().cutoffs.fetch_add(1, std::memory_order_relaxed); }
+
+  Stats stats() const;
+
+  void resetStats();
+
+  std::ostream& printStats(std::ostream& s) const;
+
+private:
+
+  static const int DEPTH_SLOTS = 3; /**< Depth-preferred entries per bucket */
+  static const int COUNTER_SLOTS = 64; /**< Cache lines of counters, see Counters */
+
+  /**
+   * An entry as stored: the full key, to verify the position, and the
+   * packed Entry. The key is stored XORed with the entry, so that an
+   * entry torn by threads writing the slot at the same time does not
+   * verify.
+   */
+  struct Slot {
+    uint64_t check;		/**< Key of the position XOR data */
+    uint64_t data;		/**< Packed Entry */
+  };
+
+  /**
+   * A cache line of entries.
+   */
+  struct alignas(64) Bucket {
+    Slot slot[DEPTH_SLOTS + 1];	/**< Depth-preferred entries, then the always-replace entry */
+  };
+
+  static_assert(sizeof(Bucket) == 64);
+
+  /**
+   * Stats, counted by several threads. Each thread counts in one of
+   * COUNTER_SLOTS cache lines, see counters(), so that the threads
+   * probing the table do not contend on the counters; stats() sums
+   * them.
+   */
+  struct alignas(64) Counters {
+    std::atomic<uint64_t> probes;  /**< See Stats */
+    std::atomic<uint64_t> hits;	   /**< See Stats */
+    std::atomic<uint64_t> cutoffs; /**< See Stats */
+    std::atomic<uint64_t> stores;  /**< See Stats */
+  };
+
+  Counters& counters();
+
+  static void read(const Slot& slot, uint64_t& key, uint64_t& data);
+  static void write(Slot& slot, uint64_t key, uint64_t data);
+
+  TranspositionTable();
+
+  static uint64_t pack(const Entry& e);
+  static Entry unpack(uint64_t data);
+
+  std::vector<Bucket> buckets;	/**< The table; its size is a power of 2 */
+  uint64_t mask;		/**< Number of buckets - 1 */
+  Counters stats_[COUNTER_SLOTS]; /**< Usage counters, by thread */
+};
+
+/** 
+ * Combine the hash of a position with the evaluator and the size of
+ * the board, as the cached values depend on all three: the same
+ * squares are a position of each board size that contains them, with
+ * other moves.
+ * 
+ * @param hash See Board::hash()
+ * @param evaluator 
+ * 
+ * @return The key of a position in the table
+ */
+inline uint64_t TranspositionTable::key(uint64_t hash, const StaticEvaluator& evaluator)
+{
+  const uint64_t tag = ( uint64_t(evaluator.id) << 16 ) | ( Board::w() << 8 ) | Board::h();
+  return hash ^ ( tag * 0xd6e8feb86659fd93UL );
+}
+
+/** 
+ * Pack an entry into 64 bits.
+ * 
+ * @param e 
+ * 
+ * @return 
+ */
+inline uint64_t TranspositionTable::pack(const Entry& e)
+{
+  return static_cast<uint8_t>(e.value)
+    | ( static_cast<uint64_t>(e.bound) << 8 )
+    | ( static_cast<uint64_t>(e.depth) << 16 )
+    | ( static_cast<uint64_t>(e.move) << 24 );
+}
+
+/** 
+ * Unpack an entry packed by pack().
+ * 
+ * @param data 
+ * 
+ * @return 
+ */
+inline TranspositionTable::Entry TranspositionTable::unpack(uint64_t data)
+{
+  return Entry {
+    .value = static_cast<value_type>(data & 0xff),
+    .bound = static_cast<Bound>(( data >> 8 ) & 0xff),
+    .depth = static_cast<uint8_t>(( data >> 16 ) & 0xff),
+    .move  = static_cast<uint8_t>(( data >> 24 ) & 0xff),
+  };
+}
+
+/** 
+ * The counters of this thread. The threads take the slots in turn,
+ * so threads searching at the same time count in different cache
+ * lines, unless there are more than COUNTER_SLOTS of them.
+ * 
+ * @return 
+ */
+inline TranspositionTable::Counters& TranspositionTable::counters()
+{
+  static std::atomic<unsigned> threads(0);
+  thread_local const unsigned slot = threads++ % COUNTER_SLOTS;
+  return stats_[slot];
+}
+
+/** 
+ * Read a slot that other threads may be writing.
+ * 
+ * @param slot 
+ * @param key Set to the key, which is garbage if the words are torn
+ * @param data Set to the packed entry
+ */
+inline void TranspositionTable::read(const Slot& slot, uint64_t& key, uint64_t& data)
+{
+  data = std::atomic_ref<uint64_t>(const_cast<uint64_t&>(slot.data)).load(std::memory_order_relaxed);
+  key = data ^ std::atomic_ref<uint64_t>(const_cast<uint64_t&>(slot.check)).load(std::memory_order_relaxed);
+}
+
+/** 
+ * Write a slot that other threads may be reading.
+ * 
+ * @param slot 
+ * @param key 
+ * @param data Packed entry
+ */
+inline void TranspositionTable::write(Slot& slot, uint64_t key, uint64_t data)
+{
+  std::atomic_ref<uint64_t>(slot.data).store(data, std::memory_order_relaxed);
+  std::atomic_ref<uint64_t>(slot.check).store(key ^ data, std::memory_order_relaxed);
+}
+
+/** 
+ * Look up a position.
+ * 
+ * @param key See key()
+ * @param entry Set to the stored entry, if found
+ * 
+ * @return True if the position was found
+ */
+inline bool TranspositionTable::probe(uint64_t key, Entry& entry)
+{
+  if( buckets.empty() ) return false;
+  Counters& c = counters();
+  c.probes.fetch_add(1, std::memory_order_relaxed);
+  const Bucket& b = buckets[key & mask];
+  for(const auto& slot : b.slot) {
+    uint64_t k, data;
+    read(slot, k, data);
+    if( k == key && data != 0 ) {
+      entry = unpack(data);
+      c.hits.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+#endif	// TRANSPOSITION_TABLE_HPP
@@ -14,12 +14,42 @@
 #include "BoardTraits.hpp"
 #include "StaticEvaluator.hpp"
 #include "SimpleStaticEvaluator.hpp"
+#include "Search.hpp"
+#include "EndgameSolver.hpp"
+#include "TranspositionTable.hpp"
+#include "MoveOrdering.hpp"
+#include "Deadline.hpp"
+#include "WorkStealingPool.hpp"
 
 #include <iostream>
 #include <algorithm>
+#include <new>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <exception>
 #include <cassert>
 
 bool TreeNode::print_recursively = false;
+TreeNode::Backend TreeNode::backend = TreeNode::TREE;
+int TreeNode::move_time_ms = 0;
+int TreeNode::search_depth = 0;
+size_t TreeNode::max_nodes = 0;
+std::atomic<uint64_t> TreeNode::evictions = 0;
+int TreeNode::threads = 1;
+TreeNode::Parallel TreeNode::parallel = TreeNode::YBWC;
+int TreeNode::min_split_depth = 3;
+std::atomic<uint64_t> TreeNode::splits = 0;
+TreeNode::Algorithm TreeNode::algorithm = TreeNode::ALPHABETA;
+int TreeNode::aspiration_window = 4;
+std::atomic<uint64_t> TreeNode::nodes = 0;
+int TreeNode::endgame_empties = 14;
+bool TreeNode::wld = false;
+bool TreeNode::solved = false;
+thread_local const TreeNode::SplitBase* TreeNode::split_ = nullptr;
+thread_local uint64_t TreeNode::thread_nodes_ = 0;
+
+static_assert(sizeof(TreeNode) == 24, "Memory per node, see TreeNode::children_");
 
 /** 
  * Constructor of a node with a given player and board.
@@ -33,10 +63,12 @@ bool TreeNode::print_recursively = false;
  */
 TreeNode::TreeNode(BoardTraits::Player player, const Board& board, int8_t x, int8_t y)
   : board_(board),
-    children_(),
+    children_(0),
     bits({
       .minMaxVal  = 0,
       .isExpanded = false,
+      .numChildren = 0,
+      .mobility   = UNKNOWN,
       .player     = player,
       .x          = x,
       .y          = y,
@@ -50,6 +82,7 @@ TreeNode::TreeNode(BoardTraits::Player player, const Board& board, int8_t x, int
  * @param other 
  */
 TreeNode::TreeNode(TreeNode&& other)
+  : TreeNode()
 {
   other.swap(*this);
 }
@@ -64,38 +97,46 @@ TreeNode::~TreeNode()
 }
 
 /** 
- * Add child nodes
+ * Add child nodes, as one block from the node arena
  *
  * 
  * @return 
  */
 inline void TreeNode::expandOneLevel() const
 {
+  static_assert(Board::MAX_MOVES < 64, "bits.numChildren has 6 bits");
+  static_assert(Board::MAX_MOVES <= NodeArena<TreeNode>::MAX_BLOCK, "Children are one block");
+
   if(isExpanded()) return;
-  auto&& move_bag(moves(player()));
+  const auto mob = mobility();
+  const uint64_t legal = ( mob == MOVES ) ? board().legalMoves(player()) : 0;
+  // If we have no moves but the other player has a move
+  // make it his turn
+  const size_t count = ( mob == MOVES ) ? Board::popcount(legal) : ( mob == PASS ) ? 1 : 0;
   
   try {
-    if( move_bag.empty() ) {	// We have no moves
-      // If the other player has a move
-      // make it his turn
-      if( hasLegalMove(~player()) ) {
-	addChild(new TreeNode(~player(), board()));
-      }
-    } else {			// There are moves, we must make one
-      while( !move_bag.empty() ) {
-	const auto& m  = move_bag.front();
-	const auto& [x, y, childBoard ] = m;
-	addChild(new TreeNode(~player(), childBoard, x, y));
-	move_bag.pop_front();
+    if(count > 0) {
+      auto& arena = NodeArena<TreeNode>::getInstance();
+      children_ = arena.allocate(count);
+      bits.numChildren = count;
+      auto child = arena.pointer(children_);
+      if( mob == PASS ) {	// We pass, the other player moves
+	new (child) TreeNode(~player(), board());
+	child->bits.mobility = MOVES;
+      } else {			// There are moves, we must make one
+	for(auto moves = legal; moves != 0; moves &= moves - 1) {
+	  const uint8_t sq = Board::bitscan(moves);
+	  new (child) TreeNode(~player(), board(), sq & 7, sq >> 3);
+	  child->board_.play(player(), sq);
+	  ++child;
+	}
       }
     }
     setIsExpanded(true);
   } catch(std::bad_alloc& e) {
     std::cerr << e.what() << "\n";
-    // Now we have only some children, so not
+    // Now we have no children, so
     // we cannot determine accurate value.
-    // NOTE: sets isExpanded to false.
-    deleteDescendents();
   }
 }
 
@@ -110,17 +151,12 @@ void TreeNode::expandNode(int numLevels) const
 {
   if(numLevels >= 1) {
     expandOneLevel();
-    for( const auto& child : children_ ) {
+    for( const auto& child : children() ) {
       child->expandNode(numLevels - 1);
     }
   }
 }
 
-void TreeNode::addChild(TreeNode* child) const
-{
-  children_.push_front(child);
-}
-
 /** 
  * Output a TreeNode.
  * 
@@ -146,6 +182,248 @@ std::ostream& TreeNode::print(std::ostream& s) const
 }
 
 
+/**
+ * Thrown in the threads searching below a split point when the
+ * search of the split point is abandoned.
+ * 
+ */
+struct SplitAborted { };
+
+/**
+ * A node whose children are searched by several threads, see split().
+ * Split points nest: parent is the split point whose search the
+ * thread was part of when it created this one.
+ * 
+ */
+struct TreeNode::SplitBase {
+  const SplitBase* parent;	/**< Enclosing split point, or nullptr */
+  std::atomic<bool> aborted;	/**< Cutoff or error, stop searching */
+
+  /** 
+   * @return True if an enclosing split point was aborted
+   */
+  bool abortedAbove() const {
+    for(auto p = parent; p != nullptr; p = p->parent) {
+      if(p->aborted) return true;
+    }
+    return false;
+  }
+};
+
+/**
+ * The shared state of the search of the children of a split node,
+ * with the variables of alphabeta_helper().
+ * 
+ */
+template <typename Compare>
+struct TreeNode::SplitPoint : public SplitBase {
+  const TreeNode* node;		/**< The node whose children are searched */
+  const StaticEvaluator* evaluator; /**< As in alphabeta() */
+  int depth;			/**< Remaining depth of node */
+  bool prune;			/**< As in alphabeta() */
+  const ordered_children_type* ordered; /**< The children in the order of search */
+  std::atomic<size_t> next;	/**< Next child to search */
+  std::atomic<int> pending;	/**< Helper tasks not finished or canceled */
+  std::mutex mutex;		/**< Lock of the following fields */
+  value_type bestVal;		/**< Best value so far */
+  const TreeNode* bestChild;	/**< Child of bestVal */
+  value_type changing;		/**< Bound raised by the player of node */
+  value_type fixed;		/**< Bound of the other player */
+  bool root;			/**< Node is the root, searched with pruning */
+  value_type bound;		/**< Bound of the window of node, raised by its player */
+  Compare better;		/**< Order of values for the player of node */
+  std::exception_ptr error;	/**< Exception thrown by a searching thread */
+};
+
+/** 
+ * Unwind the search of this thread if a split point it takes part in
+ * was aborted.
+ *
+ * @throw SplitAborted
+ */
+inline void TreeNode::checkAborted()
+{
+  for(auto p = split_; p != nullptr; p = p->parent) {
+    if(p->aborted) throw SplitAborted();
+  }
+}
+
+/** 
+ * Add the nodes searched by this thread to nodes. Each thread counts
+ * its nodes apart, so that the threads do not write the cache line
+ * of nodes at every node, and adds them at the end of its part of
+ * the search: a split point, a root split or getComputerMove().
+ * 
+ */
+inline void TreeNode::addThreadNodes()
+{
+  nodes.fetch_add(thread_nodes_, std::memory_order_relaxed);
+  thread_nodes_ = 0;
+}
+
+/** 
+ * Search the children of a split point until all are taken, like the
+ * loop of alphabeta_helper(). Run by the thread that created the
+ * split point and by helpers. A cutoff aborts the split point. An
+ * exception aborts it too, and is kept to be rethrown by split().
+ * 
+ * @param sp 
+ */
+template <typename Compare>
+void TreeNode::searchSplit(SplitPoint<Compare>& sp) const
+{
+  const auto saved = split_;
+  split_ = &sp;
+  const bool maximize = ( player() == Board::WHITE );
+  try {
+    for(size_t i; !sp.aborted && ( i = sp.next++ ) < sp.ordered->size(); ) {
+      const TreeNode* child = (*sp.ordered)[i];
+      value_type changing;
+      {
+	std::lock_guard<std::mutex> lock(sp.mutex);
+	changing = sp.root ? rootBound(sp.bound, sp.bestVal, sp.better) : sp.changing;
+      }
+      child->searchYounger(*sp.evaluator, sp.depth - 1, sp.prune, maximize,
+			   maximize ? changing : sp.fixed,
+			   maximize ? sp.fixed : changing);
+      child->evictIfOverBudget();
+      std::lock_guard<std::mutex> lock(sp.mutex);
+      if( sp.better(sp.bestVal, child->minMaxVal()) ) {
+	sp.bestVal = child->minMaxVal();
+	sp.bestChild = child;
+      }
+      if(sp.prune) {
+	sp.changing = std::max(sp.changing, sp.bestVal, sp.better);
+	if( !sp.better(sp.changing, sp.fixed) && !sp.aborted ) {
+	  if( child->x() >= 0 ) {
+	    MoveOrdering::getInstance()
+	      .cutoff(player(), Board::square(child->x(), child->y()),
+		      board().numTiles(), sp.depth, false);
+	  }
+	  sp.aborted = true;
+	}
+      }
+    }
+  } catch(SplitAborted& e) {
+    // This or an enclosing split point was aborted
+  } catch(...) {
+    std::lock_guard<std::mutex> lock(sp.mutex);
+    if(!sp.error) {
+      sp.error = std::current_exception();
+    }
+    sp.aborted = true;
+  }
+  addThreadNodes();
+  split_ = saved;
+}
+
+/** 
+ * The task of a thread helping with a split point.
+ * 
+ * @param arg The SplitPoint
+ */
+template <typename Compare>
+void TreeNode::helpSplit(void* arg)
+{
+  auto& sp = *static_cast<SplitPoint<Compare>*>(arg);
+  sp.node->searchSplit(sp);
+  --sp.pending;			// The last access: sp may be gone
+}
+
+/** 
+ * Search the remaining children of this node in parallel (Young
+ * Brothers Wait). The eldest child has been searched, so the bounds
+ * are known to be worth sharing. Idle threads of the
+ * WorkStealingPool are offered to help; this thread searches too,
+ * then waits for the helpers, running other tasks meanwhile.
+ * 
+ * @param sp The split point, on the stack of this thread
+ *
+ * @throw SplitAborted if an enclosing split point was aborted
+ * @throw Deadline::Expired
+ */
+template <typename Compare>
+void TreeNode::split(SplitPoint<Compare>& sp) const
+{
+  auto& pool = WorkStealingPool::getInstance();
+  ++splits;
+  const int helpers = std::min<int>(pool.idle(), sp.ordered->size() - sp.next - 1);
+  sp.pending = helpers;
+  for(int k = 0; k < helpers; ++k) {
+    pool.push({ &TreeNode::helpSplit<Compare>, &sp });
+  }
+  searchSplit(sp);
+  sp.pending -= pool.cancel(&sp);
+  while(sp.pending > 0) {
+    if(!pool.runOne()) {
+      std::this_thread::yield();
+    }
+  }
+  if(sp.error) {
+    std::rethrow_exception(sp.error);
+  }
+  if(sp.abortedAbove()) {
+    throw SplitAborted();
+  }
+}
+
+/** 
+ * Sort children so that the most promising moves are searched first,
+ * according to MoveOrdering. The sort is stable, so children of equal
+ * score keep their order.
+ * 
+ * @param ordered The children, sorted in place
+ * @param depth Remaining depth of this node
+ * @param ttMove Best move according to the transposition table
+ */
+void TreeNode::orderChildren(ordered_children_type& ordered, int depth, uint8_t ttMove) const
+{
+  const auto& ordering = MoveOrdering::getInstance();
+  const int ply = board().numTiles();
+  int score[Board::MAX_MOVES];
+  for(size_t i = 0; i < ordered.size(); ++i) {
+    const TreeNode* child = ordered[i];
+    score[i] = ordering.score(player(), Board::square(child->x(), child->y()),
+			      child->board(), ply, depth, ttMove);
+  }
+  // Insertion sort: there are few children and it needs no memory
+  for(size_t i = 1; i < ordered.size(); ++i) {
+    const int s = score[i];
+    TreeNode* child = ordered[i];
+    size_t j = i;
+    for(/* Empty */; j > 0 && score[j-1] < s; --j) {
+      score[j] = score[j-1];
+      ordered[j] = ordered[j-1];
+    }
+    score[j] = s;
+    ordered[j] = child;
+  }
+}
+
+/** 
+ * The bound of the window of a younger child of the root, raised by
+ * the player to move: one worse than the best value so far, instead
+ * of the best value. A child as good as the best one then gets its
+ * exact value, not a bound equal to it, so that findBestChildren()
+ * only finds children of the best value, and all of them, like
+ * Search::bestMoves().
+ * 
+ * @param bound The bound of the window of the root
+ * @param bestVal The best value of the children searched so far
+ * @param better The order of values for the player to move
+ * 
+ * @return The bound of the window of the child
+ */
+template <typename Compare>
+inline TreeNode::value_type TreeNode::rootBound(value_type bound, value_type bestVal, Compare better)
+{
+  if( better(MIN_VAL, MAX_VAL) ) {	// maximizing player
+    return std::max<int>(bound, bestVal - 1);
+  } else {
+    return std::min<int>(bound, bestVal + 1);
+  }
+}
+
 /** 
  * This alpha-beta algorithm helper function is useful to capture the
  * common logic for both players. The parameters changing and fixed
@@ -158,6 +436,15 @@ std::ostream& TreeNode::print(std::ostream& s) const
  * -#. alpha-abeta pruning when prune is set to true;
  * -#. same code working for Min and Max without performance penalty, which
  *     would result from using conditionals.
+ *
+ * Parameters alpha and beta refer to the same variables as changing
+ * and fixed, so that each child is searched with the window narrowed
+ * by its elder siblings. With pruning, the children are searched in
+ * the order given by orderChildren(), and cutoffs are reported back
+ * to MoveOrdering. The children after the first are searched by
+ * searchYounger(). At the root, the window of a younger child is only
+ * narrowed to one worse than the best value, see rootBound(), so
+ * that the children of the best value get exact values.
  * 
  * @param evaluator 
  * @param depth 
@@ -168,36 +455,137 @@ std::ostream& TreeNode::print(std::ostream& s) const
  * @param fixed
  * @param worst_val 
  * @param better 
+ * @param ttMove Best move according to the transposition table
+ * @param root True if this node is the root of the search
+ *
+ * @return The square of the best move, or TranspositionTable::NO_MOVE
+ *         if the player passes.
  */
 template <typename Compare>
-inline void TreeNode::alphabeta_helper(const StaticEvaluator& evaluator,
-				       int depth,
-				       bool prune,
-				       value_type alpha, value_type beta,
-				       value_type& changing,
-				       const value_type& fixed,
-				       value_type worst_val,
-				       Compare better) const
+inline uint8_t TreeNode::alphabeta_helper(const StaticEvaluator& evaluator,
+					  int depth,
+					  bool prune,
+					  const value_type& alpha, const value_type& beta,
+					  value_type& changing,
+					  const value_type& fixed,
+					  value_type worst_val,
+					  Compare better,
+					  uint8_t ttMove,
+					  bool root) const
 {
+  const value_type bound = changing;
   value_type bestVal = worst_val;
+  const TreeNode* bestChild = nullptr;
+  ordered_children_type ordered;
+  for( auto child : children() ) {
+    ordered.push_back(child);
+  }
   if(prune) {
     // Mark all children as suboptimal as not all will be searched
-    std::for_each(children().begin(), children().end(),
+    std::for_each(ordered.begin(), ordered.end(),
 		  [bestVal](auto& ch) { ch->setMinMaxVal(bestVal); });
+    MoveOrdering::getInstance().countNode();
+    if( ordered.size() > 1 ) {
+      orderChildren(ordered, depth, ttMove);
+    }
   }
-  for( auto child : children() ) {
-    child->alphabeta(evaluator, depth - 1, prune, alpha, beta);
-    // NOTE: std::max is like f(a,b) -> ( better(a,b) ? b : a ) and better == operator< 
-    bestVal = std::max(bestVal, child->minMaxVal(), better);
+  for( size_t i = 0; i < ordered.size(); ++i ) {
+    if( i == 1 && threads > 1 && parallel == YBWC && depth >= min_split_depth
+	&& ordered.size() > 2 && WorkStealingPool::getInstance().idle() > 0 ) {
+      // The eldest brother is searched, the young ones in parallel
+      SplitPoint<Compare> sp;
+      sp.parent = split_;
+      sp.aborted = false;
+      sp.node = this;
+      sp.evaluator = &evaluator;
+      sp.depth = depth;
+      sp.prune = prune;
+      sp.ordered = &ordered;
+      sp.next = i;
+      sp.bestVal = bestVal;
+      sp.bestChild = bestChild;
+      sp.changing = changing;
+      sp.fixed = fixed;
+      sp.root = root && prune;
+      sp.bound = bound;
+      sp.better = better;
+      split(sp);
+      bestVal = sp.bestVal;
+      bestChild = sp.bestChild;
+      changing = sp.changing;
+      break;
+    }
+    const TreeNode* child = ordered[i];
+    const bool maximize = ( player() == Board::WHITE );
+    if(i == 0) {
+      child->alphabeta(evaluator, depth - 1, prune, alpha, beta);
+    } else if( root && prune ) {
+      const value_type younger = rootBound(bound, bestVal, better);
+      child->searchYounger(evaluator, depth - 1, true, maximize,
+			   maximize ? younger : fixed,
+			   maximize ? fixed : younger);
+    } else {
+      child->searchYounger(evaluator, depth - 1, prune, maximize, alpha, beta);
+    }
+    child->evictIfOverBudget();
+    // NOTE: Like std::max(bestVal, child->minMaxVal(), better), also recording the child
+    if( better(bestVal, child->minMaxVal()) ) {
+      bestVal = child->minMaxVal();
+      bestChild = child;
+    }
     if(prune) {
       changing = std::max(changing, bestVal, better);
       if(!better(changing, fixed)) {
+	if( child->x() >= 0 ) {
+	  MoveOrdering::getInstance()
+	    .cutoff(player(), Board::square(child->x(), child->y()),
+		    board().numTiles(), depth, i == 0);
+	}
 	break;
       }
     }
   }
   assert( bestVal != worst_val);
   setMinMaxVal(bestVal);
+  return ( bestChild->x() < 0 )
+    ? TranspositionTable::NO_MOVE
+    : Board::square(bestChild->x(), bestChild->y());
+}
+
+
+/** 
+ * Search a child which is not the first one searched by its parent.
+ *
+ * With the PVS algorithm, the first child is expected to be the best,
+ * so the others are only shown not to be better by a search with a
+ * null window at the bound of the parent, which prunes much more. A
+ * child which turns out better, but not good enough for a cutoff, is
+ * searched again with the window (alpha, beta).
+ * 
+ * @param evaluator 
+ * @param depth 
+ * @param prune 
+ * @param maximize True if the parent is the maximizing player
+ * @param alpha 
+ * @param beta 
+ */
+void TreeNode::searchYounger(const StaticEvaluator& evaluator, int depth,
+			     bool prune, bool maximize,
+			     value_type alpha, value_type beta) const
+{
+  if(!prune || algorithm != PVS) {
+    alphabeta(evaluator, depth, prune, alpha, beta);
+  } else if(maximize) {
+    alphabeta(evaluator, depth, true, alpha, alpha + 1);
+    if( minMaxVal() > alpha && minMaxVal() < beta ) {
+      alphabeta(evaluator, depth, true, alpha, beta);
+    }
+  } else {
+    alphabeta(evaluator, depth, true, beta - 1, beta);
+    if( minMaxVal() < beta && minMaxVal() > alpha ) {
+      alphabeta(evaluator, depth, true, alpha, beta);
+    }
+  }
 }
 
 
@@ -213,6 +601,11 @@ inline void TreeNode::alphabeta_helper(const StaticEvaluator& evaluator,
  * a child can be easily retrieved by calling child's minMaxVal()
  * method.
  *
+ * Values are also cached in the TranspositionTable, so a position
+ * reached by another order of moves is not searched again. Only
+ * results of searches to the same depth are used, so that the
+ * values are exactly those of a search without the table.
+ *
  * @param evaluator Static evaluator to use
  * @param depth Traverse descendents up to this depth
  * @param prune If true, do pruning, else do not, thus
@@ -226,26 +619,188 @@ void TreeNode::alphabeta(const StaticEvaluator& evaluator, int depth,
 			 bool prune,
 			 value_type alpha, value_type beta) const
 {
+  Deadline::check();
+  checkAborted();
+  ++thread_nodes_;
   if(depth <= 0 || isLeaf() ) {
     setMinMaxVal(evaluator(board(), player(), depth));
     return;
   } 
 
+  auto& table = TranspositionTable::getInstance();
+  TranspositionTable::Entry entry;
+  uint8_t ttMove = TranspositionTable::NO_MOVE;
+  if( table.probe(TranspositionTable::key(hash(), evaluator), entry) ) {
+    if( entry.depth == depth
+	&& ( entry.bound == TranspositionTable::EXACT
+	     || ( entry.bound == TranspositionTable::LOWER && entry.value >= beta )
+	     || ( entry.bound == TranspositionTable::UPPER && entry.value <= alpha ) ) ) {
+      table.countCutoff();
+      setMinMaxVal(entry.value);
+      return;
+    }
+    ttMove = entry.move;
+  }
+
+  searchChildren(evaluator, depth, prune, alpha, beta, ttMove);
+}
+
+/** 
+ * The best move stored in the transposition table for this node.
+ * 
+ * @param evaluator 
+ * 
+ * @return The square of the move, or TranspositionTable::NO_MOVE
+ */
+uint8_t TreeNode::tableMove(const StaticEvaluator& evaluator) const
+{
+  TranspositionTable::Entry entry;
+  return TranspositionTable::getInstance().probe(TranspositionTable::key(hash(), evaluator), entry)
+    ? entry.move
+    : TranspositionTable::NO_MOVE;
+}
+
+/** 
+ * Search the children of a node which is not a leaf, set the value
+ * of the node and store it in the TranspositionTable. Unlike
+ * alphabeta(), it never takes the value from the table, so the
+ * children values are always set.
+ * 
+ * @param evaluator 
+ * @param depth 
+ * @param prune 
+ * @param alpha 
+ * @param beta 
+ * @param ttMove Best move according to the transposition table
+ * @param root True if this node is the root of the search
+ */
+void TreeNode::searchChildren(const StaticEvaluator& evaluator, int depth,
+			      bool prune,
+			      value_type alpha, value_type beta,
+			      uint8_t ttMove, bool root) const
+{
+  value_type a = alpha, b = beta;
+  uint8_t move;
+
   // The code could be refactored because Min and Max code is so
   // similar
   if( player() == Board::WHITE ) {	// maximizing player
-    alphabeta_helper(evaluator, depth, prune,
-		     alpha, beta,
-		     alpha, beta,
-		     MIN_VAL,
-		     std::less<value_type>());
+    move = alphabeta_helper(evaluator, depth, prune,
+			    a, b,
+			    a, b,
+			    MIN_VAL,
+			    std::less<value_type>(),
+			    ttMove, root);
   } else {			// minimizing player
     assert(player() == Board::BLACK);
-    alphabeta_helper(evaluator, depth, prune,
-		     alpha, beta,
-		     beta, alpha,
-		     MAX_VAL,
-		     std::greater<value_type>());
+    move = alphabeta_helper(evaluator, depth, prune,
+			    a, b,
+			    b, a,
+			    MAX_VAL,
+			    std::greater<value_type>(),
+			    ttMove, root);
+  }
+
+  const auto val = minMaxVal();
+  const auto bound = ( val <= alpha ) ? TranspositionTable::UPPER
+    : ( val >= beta ) ? TranspositionTable::LOWER
+    : TranspositionTable::EXACT;
+  TranspositionTable::getInstance()
+    .store(TranspositionTable::key(hash(), evaluator), val, bound, depth, move);
+}
+
+/** 
+ * Search the children of the root in parallel, in threads threads.
+ * The threads take the children one by one, in the order of
+ * orderChildren(), and share the best value found so far: with
+ * pruning, a child is searched with the window bounded by one worse
+ * than the best value of the children finished before it started, as
+ * it would be in the serial search, see rootBound(). A child of the
+ * best value thus gets its exact value, and without pruning every
+ * child does, so the best children are those of the serial search.
+ *
+ * At depth 128 or more without pruning, the children are solved by
+ * minmax() instead, like in getComputerMove().
+ *
+ * @param evaluator 
+ * @param depth Depth of the search, at least 1
+ * @param prune 
+ * @param ttMove Best move according to the transposition table
+ *
+ * @throw Deadline::Expired
+ */
+void TreeNode::searchRoot(const StaticEvaluator& evaluator, int depth,
+			  bool prune, uint8_t ttMove) const
+{
+  ordered_children_type ordered;
+  for( auto child : children() ) {
+    ordered.push_back(child);
+  }
+  if( prune && ordered.size() > 1 ) {
+    orderChildren(ordered, depth, ttMove);
+  }
+
+  const bool maximize = ( player() == Board::WHITE );
+  const bool exact = !prune && depth >= 128;
+  std::atomic<int> best(maximize ? MIN_VAL : MAX_VAL);
+  std::atomic<size_t> next(0);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  const auto work = [&]() {
+    try {
+      for(size_t i; ( i = next++ ) < ordered.size(); ) {
+	const TreeNode* child = ordered[i];
+	if(exact) {
+	  child->minmax();
+	} else {
+	  const value_type bound = !prune ? ( maximize ? MIN_VAL : MAX_VAL )
+	    : maximize ? rootBound(MIN_VAL, best, std::less<value_type>())
+	    : rootBound(MAX_VAL, best, std::greater<value_type>());
+	  child->alphabeta(evaluator, depth - 1, prune,
+			   maximize ? bound : MIN_VAL,
+			   maximize ? MAX_VAL : bound);
+	}
+	// Like best = std::max(best, child->minMaxVal()), atomically
+	const int val = child->minMaxVal();
+	int cur = best;
+	while( ( maximize ? val > cur : val < cur ) && !best.compare_exchange_weak(cur, val) ) { }
+	child->evictIfOverBudget();
+      }
+    } catch(...) {		// Deadline::Expired or std::bad_alloc
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if(!error) {
+	error = std::current_exception();
+      }
+      next = ordered.size();	// Stop the other threads
+    }
+    addThreadNodes();
+  };
+
+  std::vector<std::thread> workers;
+  const size_t numThreads = std::min<size_t>(threads, ordered.size());
+  for(size_t t = 1; t < numThreads; ++t) {
+    workers.emplace_back(work);
+  }
+  work();
+  for(auto& worker : workers) {
+    worker.join();
+  }
+  if(error) {
+    std::rethrow_exception(error);
+  }
+
+  setMinMaxVal(best);
+  if(!exact) {
+    uint8_t move = TranspositionTable::NO_MOVE;
+    for(const auto child : ordered) {
+      if( child->minMaxVal() == minMaxVal() && child->x() >= 0 ) {
+	move = Board::square(child->x(), child->y());
+	break;
+      }
+    }
+    TranspositionTable::getInstance()
+      .store(TranspositionTable::key(hash(), evaluator), minMaxVal(), TranspositionTable::EXACT, depth, move);
   }
 }
 
@@ -263,8 +818,9 @@ void TreeNode::minmax() const
 
   if( player() == Board::WHITE ) {	// maximizing player
     value_type bestVal = MIN_VAL;
-    for( auto& child : children()) {
+    for( auto child : children()) {
       child->minmax();
+      child->evictIfOverBudget();
       bestVal = std::max(bestVal, child->minMaxVal());
     }
     assert( bestVal != MIN_VAL);
@@ -273,6 +829,7 @@ void TreeNode::minmax() const
     auto bestVal = MAX_VAL;
     for( auto child : children()) {
       child->minmax();
+      child->evictIfOverBudget();
       bestVal = std::min(bestVal, child->minMaxVal());
     }
     assert( bestVal != MAX_VAL);
@@ -291,7 +848,27 @@ void TreeNode::minmax() const
  */
 bool TreeNode::isLeaf() const
 {
-  return !hasLegalMove(Board::WHITE) && !hasLegalMove(Board::BLACK);
+  return mobility() == TERMINAL;
+}
+
+/** 
+ * Whether the player to move has a move, passes or the game is over.
+ * Found once per node and cached in bits.mobility.
+ * 
+ * @return 
+ */
+TreeNode::Mobility TreeNode::mobility() const
+{
+  if(bits.mobility == UNKNOWN) {
+    if(board().hasLegalMove(player())) {
+      bits.mobility = MOVES;
+    } else if(board().hasLegalMove(~player())) {
+      bits.mobility = PASS;
+    } else {
+      bits.mobility = TERMINAL;
+    }
+  }
+  return Mobility(bits.mobility);
 }
 
 /** 
@@ -301,19 +878,42 @@ bool TreeNode::isLeaf() const
  */
 void TreeNode::deleteDescendents() const
 {
-  for(const auto& child : children_ ) {
-    delete child;
+  if(bits.numChildren != 0) {
+    for(const auto& child : children_type(firstChild(), bits.numChildren) ) {
+      child->~TreeNode();
+    }
+    NodeArena<TreeNode>::getInstance().release(children_, bits.numChildren);
+    bits.numChildren = 0;
   }
   setIsExpanded(false);
 }
 
+/** 
+ * Keeps the tree within max_nodes nodes. Called on a node whose value
+ * has just been found: its subtree is no longer needed by the search
+ * of its parent, so it is deleted when the arena is over budget. A
+ * later search through this node expands it again. The nodes on the
+ * path being searched and their siblings are never evicted, so the
+ * tree may exceed the budget by that many nodes. The arena merges and
+ * splits released blocks, so its slabs hold about as many nodes as
+ * the peak of live nodes, and the budget bounds its memory too.
+ */
+void TreeNode::evictIfOverBudget() const
+{
+  if(max_nodes != 0 && bits.numChildren != 0
+     && NodeArena<TreeNode>::getInstance().stats().live > max_nodes) {
+    deleteDescendents();
+    ++evictions;
+  }
+}
+
 /** 
  * 
  */
 void TreeNode::deleteDescendentsExceptFor(const TreeNode *other) const
 {
   if(this == other) return;
-  for(const auto& child : children_ ) {
+  for(const auto& child : children_type(firstChild(), bits.numChildren) ) {
     if(child != other) {
       child->deleteDescendentsExceptFor(other);
     }
@@ -326,10 +926,10 @@ void TreeNode::deleteDescendentsExceptFor(const TreeNode *other) const
  * 
  * @return 
  */
-const TreeNode::children_type& TreeNode::children() const
+TreeNode::children_type TreeNode::children() const
 {
   expandOneLevel();
-  return children_;
+  return children_type(firstChild(), bits.numChildren);
 }
 
 
@@ -411,7 +1011,7 @@ int TreeNode::nodeCount(int depth) const
 {
   int count = 1;		// Count this node
   if(depth >= 1) {
-    for(auto&  child : children() ) {
+    for(auto child : children() ) {
       count += child->nodeCount(depth - 1);
     }
   }
@@ -419,27 +1019,67 @@ int TreeNode::nodeCount(int depth) const
 }
 
 /** 
- * Find the best move for the computer.
+ * The children of the best value found by a search to given depth.
+ *
+ * With the STACK backend the search below the children runs on Board
+ * values, see class Search, and uses memory proportional to the
+ * depth only.
+ *
+ * The window (alpha, beta) is only used by the serial search of the
+ * tree with pruning; a value outside of it is a bound, see
+ * searchIteration(). A child is only found best once its value is
+ * exact: with pruning, the children of a value inside the window
+ * have exact values, see rootBound(), and the others a worse value.
+ *
+ * With wld set, the search at depth 128 or more without pruning only
+ * finds the winner, see searchOutcome().
  *
  * @param evaluatorTab The table of (2) evaluators, one for each player.
- * @param depth Depth of the search.
+ * @param depth Depth of the search, at least 1.
  * @param prune If true, use alpha-beta pruning.
+ * @param alpha 
+ * @param beta 
  * 
- * @return The best child node.
+ * @return The best children, in the order of children().
+ *
+ * @throw Deadline::Expired
  */
-TreeNode TreeNode::getComputerMove(const StaticEvaluatorTable& evaluatorTab, int depth, bool prune) const
+std::vector<TreeNode*> TreeNode::findBestChildren(const StaticEvaluatorTable& evaluatorTab, int depth, bool prune,
+						  value_type alpha, value_type beta) const
 {
-  assert(!isLeaf());
-  expandOneLevel();
+  if( wld && !prune && depth >= 128 ) {
+    return searchOutcome(depth);
+  }
 
   std::vector<TreeNode*> bestChildren;
 
-  if(depth >= 1) {
-    if(prune) {
-      alphabeta(*evaluatorTab[player()], depth, true);
+  if(backend == STACK) {
+    // Like minmax(), use the score at the leaves when solving
+    static const SimpleStaticEvaluator scoreEvaluator;
+    const bool exact = !prune && depth >= 128;
+    Search search(exact ? scoreEvaluator : *evaluatorTab[player()], prune);
+    const auto best = search.bestMoves(board(), player(), depth);
+    nodes += search.nodes();
+    for(const auto& child : children()) {
+      if(best.empty()		// We pass, the only child
+	 || std::find(best.begin(), best.end(), Board::square(child->x(), child->y())) != best.end()) {
+	bestChildren.push_back(child);
+      }
+    }
+  } else {
+    if(threads > 1) {
+      WorkStealingPool::getInstance().resize(threads);
+    }
+    if(threads > 1 && ( parallel == ROOT_SPLIT || ( !prune && depth >= 128 ) )) {
+      const auto& evaluator = *evaluatorTab[player()];
+      searchRoot(evaluator, depth, prune, prune ? tableMove(evaluator) : TranspositionTable::NO_MOVE);
+    } else if(prune) {
+      const auto& evaluator = *evaluatorTab[player()];
+      searchChildren(evaluator, depth, true, alpha, beta, tableMove(evaluator), true);
     } else if(!prune) {
       if(depth < 128) {
-	alphabeta(*evaluatorTab[player()], depth, false);
+	searchChildren(*evaluatorTab[player()], depth, false, MIN_VAL, MAX_VAL,
+		       TranspositionTable::NO_MOVE);
       } else {			// depth >= 128
 	minmax();
       }
@@ -449,8 +1089,339 @@ TreeNode TreeNode::getComputerMove(const StaticEvaluatorTable& evaluatorTab, int
 	bestChildren.push_back(child);
       }
     }
-    assert(!bestChildren.empty());
-  } else {			// depth <= 0
+  }
+  assert(!bestChildren.empty());
+  return bestChildren;
+}
+
+namespace {
+  /**
+   * The helper threads of a Lazy SMP search, see
+   * SearchTraits::LAZY_SMP. While the object lives, each helper
+   * deepens its own Search of the root, starting at depth 1 or 2 so
+   * that the helpers do not move in lock-step, and fills the
+   * TranspositionTable shared with the search of the caller.
+   *
+   */
+  class LazyHelpers {
+  public:
+    /** 
+     * Start the helpers if TreeNode::parallel is LAZY_SMP, and the
+     * search is not the exact search of minmax().
+     * 
+     * @param board 
+     * @param player The player to move
+     * @param evaluator The evaluator of the caller, sharing its entries
+     * @param depth The deepest search of a helper
+     * @param prune 
+     */
+    LazyHelpers(const Board& board, BoardTraits::Player player, const StaticEvaluator& evaluator,
+		int depth, bool prune)
+      : stop_(false)
+    {
+      if( TreeNode::threads <= 1 || TreeNode::parallel != SearchTraits::LAZY_SMP
+	  || ( !prune && depth >= 128 ) ) {
+	return;
+      }
+      depth = std::min(depth, 2 * ( Board::w() * Board::h() - board.numTiles() ));
+      for(int t = 1; t < TreeNode::threads; ++t) {
+	helpers_.emplace_back([this, board, player, &evaluator, depth, prune, t]() {
+	  Search search(evaluator, prune);
+	  search.stopOn(stop_);
+	  try {
+	    for(int d = 1 + ( t & 1 ); d <= depth; ++d) {
+	      search.value(board, player, d);
+	    }
+	  } catch(...) {	// Stopped or out of time
+	  }
+	});
+      }
+    }
+
+    /** 
+     * Stop the helpers and wait for them.
+     * 
+     */
+    ~LazyHelpers()
+    {
+      stop_ = true;
+      for(auto& helper : helpers_) {
+	helper.join();
+      }
+    }
+
+  private:
+    std::atomic<bool> stop_;		/**< Set to stop the helpers */
+    std::vector<std::thread> helpers_;	/**< The helper threads */
+  };
+}
+
+/** 
+ * One iteration of iterative deepening. Like findBestChildren(), but
+ * the serial search of the tree with pruning starts from the value of
+ * the previous iteration. With the PVS algorithm, it first tries an
+ * aspiration window, of half width aspiration_window, around that
+ * value; should the value fall outside, the search is repeated with
+ * the window open on that side. With the MTDF algorithm, the value
+ * is the first guess of mtdf().
+ * 
+ * @param evaluatorTab 
+ * @param depth 
+ * @param prune 
+ * @param guess True if minMaxVal() is the value of the previous iteration
+ * 
+ * @return The best children, in the order of children().
+ *
+ * @throw Deadline::Expired
+ */
+std::vector<TreeNode*> TreeNode::searchIteration(const StaticEvaluatorTable& evaluatorTab, int depth, bool prune,
+						 bool guess) const
+{
+  if( !guess || !prune || algorithm == ALPHABETA || backend != TREE
+      || ( threads > 1 && parallel == ROOT_SPLIT ) ) {
+    return findBestChildren(evaluatorTab, depth, prune);
+  }
+  if(algorithm == MTDF) {
+    return mtdf(evaluatorTab, depth, minMaxVal());
+  }
+  const int val = minMaxVal();
+  value_type alpha = std::max<int>(MIN_VAL, val - aspiration_window);
+  value_type beta = std::min<int>(MAX_VAL, val + aspiration_window);
+  for(;;) {
+    auto bestChildren = findBestChildren(evaluatorTab, depth, prune, alpha, beta);
+    if( minMaxVal() <= alpha && alpha > MIN_VAL ) {
+      alpha = MIN_VAL;
+    } else if( minMaxVal() >= beta && beta < MAX_VAL ) {
+      beta = MAX_VAL;
+    } else {
+      return bestChildren;
+    }
+  }
+}
+
+/** 
+ * MTD(f): the value is found by a series of searches with a null
+ * window, each telling whether the value is above or below the last
+ * guess, until the lower and upper bounds meet. The values are small
+ * integers, so few passes are needed from a good first guess. The
+ * searches repeat one another, so this relies on the
+ * TranspositionTable, which keeps the bounds found by the previous
+ * passes.
+ *
+ * The best child is the one found by a pass in which the player to
+ * move reaches the value, so such a pass is made last.
+ * 
+ * @param evaluatorTab 
+ * @param depth 
+ * @param guess The first guess of the value
+ * 
+ * @return The best children, in the order of children().
+ *
+ * @throw Deadline::Expired
+ */
+std::vector<TreeNode*> TreeNode::mtdf(const StaticEvaluatorTable& evaluatorTab, int depth, value_type guess) const
+{
+  const bool maximize = ( player() == Board::WHITE );
+  int lower = MIN_VAL, upper = MAX_VAL;
+  int g = guess;
+  bool reached = false;		// Did the last pass reach g for the player to move
+  std::vector<TreeNode*> bestChildren;
+  while(lower < upper) {
+    const int beta = ( g == lower ) ? g + 1 : g;
+    bestChildren = findBestChildren(evaluatorTab, depth, true, beta - 1, beta);
+    g = minMaxVal();
+    if(g < beta) {
+      upper = g;
+    } else {
+      lower = g;
+    }
+    reached = ( maximize == ( g >= beta ) );
+  }
+  if(!reached) {
+    if( maximize && g > MIN_VAL ) {
+      bestChildren = findBestChildren(evaluatorTab, depth, true, g - 1, g);
+    } else if( !maximize && g < MAX_VAL ) {
+      bestChildren = findBestChildren(evaluatorTab, depth, true, g, g + 1);
+    }
+  }
+  return bestChildren;
+}
+
+/** 
+ * The children of the best final score, found by the EndgameSolver.
+ * The values of this node and of the best children are set to that
+ * score.
+ * 
+ * @return The best children, in the order of children().
+ *
+ * @throw Deadline::Expired
+ */
+std::vector<TreeNode*> TreeNode::solveEndgame() const
+{
+  EndgameSolver solver;
+  const auto best = solver.bestMoves(board(), player());
+  std::vector<TreeNode*> bestChildren;
+  for(const auto& child : children()) {
+    if(best.empty()		// We pass, the only child
+       || std::find(best.begin(), best.end(), Board::square(child->x(), child->y())) != best.end()) {
+      bestChildren.push_back(child);
+    }
+  }
+  assert(!bestChildren.empty());
+  const auto val = solver.value(bestChildren.front()->board(), bestChildren.front()->player());
+  setMinMaxVal(val);
+  for(auto child : bestChildren) {
+    child->setMinMaxVal(val);
+  }
+  nodes += solver.nodes();
+  return bestChildren;
+}
+
+/** 
+ * The children of the best outcome, win, draw or loss, with perfect
+ * play: the search of minmax() when only the winner matters. The
+ * children are searched to the end of the game, by the backend, with
+ * a window around 0, so that the search only finds the sign of the
+ * final score: (-1, 1) until a child draws, then a null window for a
+ * win. The search stops at the first winning child.
+ *
+ * The values of this node and of the children searched are set to
+ * the outcome for WHITE, 1, 0 or -1; a child which is not better than
+ * the best one before it gets a bound.
+ * 
+ * @param depth Depth of the search, at least 128
+ * 
+ * @return The best children found, in the order of children().
+ *
+ * @throw Deadline::Expired
+ */
+std::vector<TreeNode*> TreeNode::searchOutcome(int depth) const
+{
+  static const SimpleStaticEvaluator scoreEvaluator;
+  const bool maximize = ( player() == Board::WHITE );
+  int best = maximize ? -1 : 1;	// The worst outcome
+  std::vector<TreeNode*> bestChildren;
+  for(const auto& child : children()) {
+    const value_type alpha = maximize ? best : -1;
+    const value_type beta = maximize ? 1 : best;
+    if(alpha >= beta) {		// Wins
+      break;
+    }
+    int val;
+    if(backend == STACK) {
+      Search search(scoreEvaluator, true);
+      val = search.value(child->board(), child->player(), depth - 1, alpha, beta);
+      nodes += search.nodes();
+    } else {
+      child->alphabeta(scoreEvaluator, depth - 1, true, alpha, beta);
+      val = child->minMaxVal();
+      child->evictIfOverBudget();
+    }
+    val = std::clamp(val, -1, 1);
+    child->setMinMaxVal(val);
+    if( bestChildren.empty() || ( maximize ? val > best : val < best ) ) {
+      best = val;
+      bestChildren.assign(1, child);
+    } else if( val == best && best == ( maximize ? -1 : 1 ) ) {
+      bestChildren.push_back(child);	// Loses too, exactly
+    }
+  }
+  setMinMaxVal(best);
+  return bestChildren;
+}
+
+/** 
+ * Find the best move for the computer.
+ *
+ * If move_time_ms is positive, the search deepens iteratively, one
+ * ply at a time up to the given depth, until the time is up. An
+ * iteration still running at the deadline is abandoned and the move
+ * is chosen by the last completed iteration. A game ends in at most
+ * two plies per empty square, so the iteration at that depth is the
+ * last one, and is searched at the given depth instead: the search at
+ * depth 128 or higher without pruning still finds the exact value, or
+ * with wld the outcome, if it completes in time.
+ *
+ * solved is set if the value of the chosen move, or with wld its
+ * outcome, is that of perfect play: the endgame solver completed, or
+ * a search at depth 128 or higher without pruning.
+ *
+ * With the LAZY_SMP parallel search, threads - 1 helper threads
+ * search the same root meanwhile, see LazyHelpers.
+ *
+ * The PVS and MTDF algorithms always deepen iteratively, even without
+ * a time budget, for the value of the previous iteration, see
+ * searchIteration().
+ *
+ * With at most endgame_empties empty squares, the move is found by
+ * solveEndgame() instead, whatever the depth. Should the solver run
+ * out of half of the time budget, the other half is searched as usual.
+ *
+ * @param evaluatorTab The table of (2) evaluators, one for each player.
+ * @param depth Depth of the search.
+ * @param prune If true, use alpha-beta pruning.
+ * 
+ * @return The best child node.
+ */
+TreeNode TreeNode::getComputerMove(const StaticEvaluatorTable& evaluatorTab, int depth, bool prune) const
+{
+  assert(!isLeaf());
+  expandOneLevel();
+
+  std::vector<TreeNode*> bestChildren;
+  search_depth = 0;
+  solved = false;
+
+  const int empties = Board::w() * Board::h() - board().numTiles();
+  int budget = move_time_ms;
+  if(depth >= 1 && empties <= endgame_empties) {
+    if(budget > 0) {
+      Deadline::start(budget / 2);
+      budget -= budget / 2;
+    }
+    try {
+      bestChildren = solveEndgame();
+      search_depth = empties;
+      solved = true;
+    } catch(Deadline::Expired& e) {
+      // Search instead
+    }
+    Deadline::stop();
+  }
+
+  if(depth >= 1 && !solved && budget > 0) {
+    const int maxDepth = std::min(depth, 2 * empties);
+    Deadline::start(budget);
+    {
+      LazyHelpers helpers(board(), player(), *evaluatorTab[player()], maxDepth, prune);
+      for(int i = 1; i <= maxDepth && !Deadline::expired(); ++i) {
+	const int d = ( i == maxDepth ) ? depth : i;
+	try {
+	  bestChildren = searchIteration(evaluatorTab, d, prune, d > 1);
+	  search_depth = d;
+	} catch(Deadline::Expired& e) {
+	  break;
+	}
+      }
+    }
+    Deadline::stop();
+    solved = !prune && search_depth >= 128;
+  } else if(depth >= 1 && !solved) {
+    LazyHelpers helpers(board(), player(), *evaluatorTab[player()], depth, prune);
+    if(prune && algorithm != ALPHABETA) {
+      const int maxDepth = std::min(depth - 1, 2 * empties);
+      for(int d = 1; d <= maxDepth; ++d) {
+	searchIteration(evaluatorTab, d, prune, d > 1);
+      }
+      bestChildren = searchIteration(evaluatorTab, depth, prune, depth > 1);
+    } else {
+      bestChildren = findBestChildren(evaluatorTab, depth, prune);
+    }
+    search_depth = depth;
+    solved = !prune && depth >= 128;
+  }
+
+  if(bestChildren.empty()) {	// depth <= 0 or out of time
     // We are very misinformed here because we don't
     // know which child is promising. We choose a random move
 
@@ -461,6 +1432,7 @@ TreeNode TreeNode::getComputerMove(const StaticEvaluatorTable& evaluatorTab, int
     std::copy(children().begin(), children().end(), bestChildren.begin());
   }
 
+  addThreadNodes();
   std::random_shuffle(bestChildren.begin(), bestChildren.end());    
   return std::move(**bestChildren.begin());
 }
@@ -14,10 +14,15 @@
 //#include "TreeNode.hpp"
 #include "Board.hpp"
 #include "StaticEvaluator.hpp"
+#include "SearchTraits.hpp"
+#include "NodeArena.hpp"
 
 
 #include <cinttypes>
-#include <forward_list>
+#include <cstddef>
+#include <atomic>
+#include <iterator>
+#include <vector>
 #include <cassert>
 
 /**
@@ -31,13 +36,52 @@
  * is undesirable but it seems harmless at this time.
  * 
  */
-class TreeNode : public StaticEvaluatorTraits {
+class TreeNode : public StaticEvaluatorTraits, public SearchTraits {
 public:
   /**
-   * The type of children container
+   * The type of children container. The children of a node are
+   * a block of adjacent nodes; iterating yields pointers to them.
    * 
    */
-  typedef std::forward_list<TreeNode*> children_type;
+  class children_type {
+  public:
+
+    /**
+     * Iterator over the children, dereferencing to TreeNode*
+     * 
+     */
+    class const_iterator {
+    public:
+      typedef std::forward_iterator_tag iterator_category; /**< Iterator category */
+      typedef TreeNode* value_type;	/**< Pointer to a child */
+      typedef std::ptrdiff_t difference_type; /**< Distance */
+      typedef void pointer;		/**< No operator-> */
+      typedef TreeNode* reference;	/**< Dereferencing yields a value */
+
+      explicit const_iterator(TreeNode* node = nullptr) : node_(node) { }
+
+      TreeNode* operator*() const { return node_; }
+      const_iterator& operator++() { ++node_; return *this; }
+      const_iterator operator++(int) { const_iterator it(*this); ++node_; return it; }
+      bool operator==(const const_iterator& other) const { return node_ == other.node_; }
+      bool operator!=(const const_iterator& other) const { return node_ != other.node_; }
+
+    private:
+      TreeNode* node_;		/**< Current child */
+    };
+    typedef const_iterator iterator; /**< Children are not modified via iterator */
+
+    children_type(TreeNode* first, size_t count) : first_(first), count_(count) { }
+
+    const_iterator begin() const { return const_iterator(first_); } /**< First child */
+    const_iterator end() const { return const_iterator(first_ + count_); } /**< Past last child */
+    size_t size() const { return count_; } /**< Number of children */
+    bool empty() const { return count_ == 0; } /**< True for a leaf */
+
+  private:
+    TreeNode* first_;		/**< First child */
+    size_t count_;		/**< Number of children */
+  };
 
   /**
    * Type of value returned by the static evaluator
@@ -46,6 +90,21 @@ public:
   typedef StaticEvaluatorTraits::value_type value_type;
 
   static bool print_recursively; /**< Print childen of the node */
+  static Backend backend;	 /**< Search implementation used by getComputerMove() */
+  static int move_time_ms;	 /**< Time budget of getComputerMove(), 0 for none */
+  static int search_depth;	 /**< Depth completed by the last getComputerMove() */
+  static size_t max_nodes;	 /**< Nodes kept in memory by a search, 0 for no limit */
+  static std::atomic<uint64_t> evictions; /**< Subtrees deleted to stay within max_nodes */
+  static int threads;		 /**< Threads searching in parallel */
+  static Parallel parallel;	 /**< How the threads share the search */
+  static int min_split_depth;	 /**< YBWC splits nodes of at least this depth */
+  static std::atomic<uint64_t> splits; /**< Nodes searched in parallel by YBWC */
+  static Algorithm algorithm;	 /**< Algorithm of the search with pruning */
+  static int aspiration_window;	 /**< Half width of the aspiration window of PVS */
+  static std::atomic<uint64_t> nodes; /**< Nodes searched by getComputerMove() */
+  static int endgame_empties;	 /**< Solve exactly with at most this many empty squares */
+  static bool wld;		 /**< Only find the winner in the search of minmax() */
+  static bool solved;		 /**< The last getComputerMove() played perfectly */
 
   TreeNode(BoardTraits::Player player = BoardTraits::BLACK,
 	   const Board& board = Board(),
@@ -88,10 +147,16 @@ public:
   BoardTraits::Player player() const { return bits.player; };
 
   int score() const;
+
+  /** 
+   * @return Hash of the board and the player to move, see Board::hash()
+   */
+  uint64_t hash() const { return board().hash(player()); }
+
   bool hasLegalMove(Board::Player player) const;
   Board::move_bag_type moves(Board::Player player) const;
 
-  const children_type& children() const;
+  children_type children() const;
 
   void minmax() const;
 
@@ -129,13 +194,23 @@ private:
 
   static const int DEFAULT_EXPANSION_DEPTH = 1;	/**< Depth when expanding a node */
 
+  /**
+   * What the player to move can do
+   * 
+   */
+  enum Mobility {
+    UNKNOWN  = 0,		/**< Not found yet */
+    MOVES    = 1,		/**< Has a legal move */
+    PASS     = 2,		/**< Has none, but the other player has */
+    TERMINAL = 3,		/**< Neither player has, the game is over */
+  };
+
+  Mobility mobility() const;
+
   std::ostream& print(std::ostream& s) const;
 
   //// NOTE: const methods that operate on mutable fields
 
-  // Installs a new child node
-  void addChild(TreeNode* child) const;
-
   // Add children of a node
   void expandOneLevel() const;
 
@@ -160,6 +235,9 @@ private:
   // Delete all descendents
   void deleteDescendents() const;
 
+  // Delete the descendents of a searched node if over max_nodes
+  void evictIfOverBudget() const;
+
   // Delete all descendents except for other
   void deleteDescendentsExceptFor(const TreeNode *other) const;
 
@@ -169,14 +247,17 @@ private:
 
   Board board_;			/**< The board */
 
-  // NOTE: Using deque for this would use 80 bytes of memory
-  // under GCC, vector uses only 24 bytes, forward_list 8 bytes.
-  // As Board currently consumes 24 bytes, the TreeNode only 32
-  mutable children_type children_;
+  // NOTE: The children are one block of bits.numChildren nodes
+  // from the node arena, addressed by a 32-bit arena index rather
+  // than a pointer. As Board consumes 16 bytes, the index 4 and
+  // the bits 4, the TreeNode takes 24
+  mutable NodeArena<TreeNode>::index_type children_; /**< Index of the first child */
 
   struct {
     mutable int minMaxVal : 8;	/**< Cached value by minmax */
     mutable bool isExpanded      : 1;	/**< Have the children been added */
+    mutable unsigned numChildren : 6;	/**< Number of children */
+    mutable unsigned mobility    : 2;	/**< Cached mobility() */
     BoardTraits::Player player   : 1;	/**< Player to move  */
     int x                        : 4; /**< x of last placed piece, or -1 */
     int y                        : 4; /**< y of last placed piece, or -1 */
@@ -185,15 +266,88 @@ private:
 
   void swap(TreeNode& other) noexcept;
 
+  /** 
+   * @return The first child, or nullptr if there are no children
+   */
+  TreeNode* firstChild() const {
+    return bits.numChildren == 0 ? nullptr : NodeArena<TreeNode>::getInstance().pointer(children_);
+  }
+
+  void searchChildren(const StaticEvaluator& evaluator,
+		      int depth,
+		      bool prune,
+		      value_type alpha,
+		      value_type beta,
+		      uint8_t ttMove,
+		      bool root = false) const;
+
+  uint8_t tableMove(const StaticEvaluator& evaluator) const;
+
+  void searchRoot(const StaticEvaluator& evaluator,
+		  int depth,
+		  bool prune,
+		  uint8_t ttMove) const;
+
+  std::vector<TreeNode*> findBestChildren(const StaticEvaluatorTable& evaluatorTab, int depth, bool prune,
+					  value_type alpha = MIN_VAL, value_type beta = MAX_VAL) const;
+
+  std::vector<TreeNode*> searchIteration(const StaticEvaluatorTable& evaluatorTab, int depth, bool prune,
+					 bool guess) const;
+
+  std::vector<TreeNode*> solveEndgame() const;
+
+  std::vector<TreeNode*> searchOutcome(int depth) const;
+
+  std::vector<TreeNode*> mtdf(const StaticEvaluatorTable& evaluatorTab, int depth, value_type guess) const;
+
+  void searchYounger(const StaticEvaluator& evaluator,
+		     int depth,
+		     bool prune,
+		     bool maximize,
+		     value_type alpha,
+		     value_type beta) const;
+
+  /**
+   * Children in the order of search
+   * 
+   */
+  typedef MoveList<TreeNode*, Board::MAX_MOVES> ordered_children_type;
+
+  void orderChildren(ordered_children_type& ordered, int depth, uint8_t ttMove) const;
+
+  struct SplitBase;
+  template <typename Compare> struct SplitPoint;
+
+  static thread_local const SplitBase* split_; /**< Split point searched by this thread */
+  static thread_local uint64_t thread_nodes_; /**< Nodes searched by this thread, not yet in nodes */
+
+  static void checkAborted();
+
+  static void addThreadNodes();
+
+  template <typename Compare>
+  void searchSplit(SplitPoint<Compare>& sp) const;
+
+  template <typename Compare>
+  static void helpSplit(void* sp);
+
+  template <typename Compare>
+  void split(SplitPoint<Compare>& sp) const;
+
+  template <typename Compare>
+  uint8_t alphabeta_helper(const StaticEvaluator& evaluator,
+			   int depth,
+			   bool prune,
+			   const value_type& alpha, const value_type& beta,
+			   value_type& changing,
+			   const value_type& fixed,
+			   value_type worst_val,
+			   Compare better,
+			   uint8_t ttMove,
+			   bool root) const;
+
   template <typename Compare>
-  void alphabeta_helper(const StaticEvaluator& evaluator,
-				       int depth,
-				       bool prune,
-				       value_type alpha, value_type beta,
-				       value_type& changing,
-				       const value_type& fixed,
-				       value_type worst_val,
-				       Compare better) const;
+  static value_type rootBound(value_type bound, value_type bestVal, Compare better);
   
 };
 
@@ -0,0 +1,175 @@
+/**
+ * @file   WorkStealingPool.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 09:40:03 2026
+ * 
+ * @brief  Work stealing thread pool implementation
+ * 
+ * 
+ */
+
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+thread_local int WorkStealingPool::index_ = 0;
+
+/** 
+ * Constructor of a pool of the calling thread only.
+ * 
+ */
+WorkStealingPool::WorkStealingPool()
+  : stop_(false),
+    idle_(0),
+    pending_(0)
+{
+  resize(1);
+}
+
+/** 
+ * Destructor. Stops the workers.
+ * 
+ */
+WorkStealingPool::~WorkStealingPool()
+{
+  stop();
+}
+
+/** 
+ * The pool of the search.
+ * 
+ * @return 
+ */
+WorkStealingPool& WorkStealingPool::getInstance()
+{
+  static WorkStealingPool pool;
+  return pool;
+}
+
+/** 
+ * Stop the workers, after their current tasks.
+ * 
+ */
+void WorkStealingPool::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for(auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+  stop_ = false;
+}
+
+/** 
+ * Set the number of threads. Must not be called while tasks run.
+ * 
+ * @param threads Number of threads including the calling thread
+ */
+void WorkStealingPool::resize(int threads)
+{
+  threads = std::max(threads, 1);
+  if(threads == size()) return;
+  stop();
+  queues_.clear();
+  for(int i = 0; i < threads; ++i) {
+    queues_.emplace_back(new Queue);
+  }
+  pending_ = 0;
+  idle_ = 0;
+  for(int i = 1; i < threads; ++i) {
+    threads_.emplace_back(&WorkStealingPool::work, this, i);
+  }
+}
+
+/** 
+ * Add a task to the queue of the calling thread.
+ * 
+ * @param task 
+ */
+void WorkStealingPool::push(const Task& task)
+{
+  {
+    std::lock_guard<std::mutex> lock(queues_[index_]->mutex);
+    queues_[index_]->tasks.push_back(task);
+  }
+  ++pending_;
+  if(idle_ > 0) {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    wake_.notify_one();
+  }
+}
+
+/** 
+ * Remove the tasks with a given argument that no thread has started
+ * yet from the queue of the calling thread.
+ * 
+ * @param arg 
+ * 
+ * @return The number of tasks removed
+ */
+int WorkStealingPool::cancel(void* arg)
+{
+  Queue& q = *queues_[index_];
+  std::lock_guard<std::mutex> lock(q.mutex);
+  const auto end = std::remove_if(q.tasks.begin(), q.tasks.end(),
+				  [arg](const Task& t) { return t.arg == arg; });
+  const int removed = q.tasks.end() - end;
+  q.tasks.erase(end, q.tasks.end());
+  pending_ -= removed;
+  return removed;
+}
+
+/** 
+ * Run one task: the newest of the calling thread, or else the oldest
+ * of another thread.
+ * 
+ * @return False if there was no task
+ */
+bool WorkStealingPool::runOne()
+{
+  if(pending_ == 0) return false;
+  const int n = size();
+  for(int k = 0; k < n; ++k) {
+    Queue& q = *queues_[( index_ + k ) % n];
+    Task task;
+    {
+      std::lock_guard<std::mutex> lock(q.mutex);
+      if(q.tasks.empty()) continue;
+      if(k == 0) {
+	task = q.tasks.back();
+	q.tasks.pop_back();
+      } else {
+	task = q.tasks.front();
+	q.tasks.pop_front();
+      }
+    }
+    --pending_;
+    task.run(task.arg);
+    return true;
+  }
+  return false;
+}
+
+/** 
+ * The loop of a worker: run tasks, sleep when there are none.
+ * 
+ * @param index Index of the queue of the worker
+ */
+void WorkStealingPool::work(int index)
+{
+  index_ = index;
+  while(!stop_) {
+    if(!runOne()) {
+      std::unique_lock<std::mutex> lock(sleepMutex_);
+      ++idle_;
+      wake_.wait_for(lock, std::chrono::milliseconds(1),
+		     [this] { return stop_ || pending_ > 0; });
+      --idle_;
+    }
+  }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file   WorkStealingPool.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 09:12:40 2026
+ * 
+ * @brief  Threads sharing the work of a parallel search
+ * 
+ * 
+ */
+
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+/**
+ * A pool of threads, each with a queue of tasks. A thread runs the
+ * tasks it pushed itself newest first, and when it has none, steals
+ * the oldest task of another thread. Tasks are pushed by the thread
+ * that calls the search, index 0, and by the workers, 1 to size() - 1.
+ *
+ * A task that waits for the tasks it pushed keeps calling runOne(),
+ * so that no thread is idle while work is available.
+ * 
+ */
+class WorkStealingPool {
+public:
+
+  /**
+   * A unit of work: a function and its argument
+   * 
+   */
+  struct Task {
+    void (*run)(void* arg);	/**< The work */
+    void* arg;			/**< Its argument */
+  };
+
+  static WorkStealingPool& getInstance();
+
+  void resize(int threads);
+
+  /** 
+   * @return The number of threads, including the calling thread
+   */
+  int size() const { return static_cast<int>(queues_.size()); }
+
+  /** 
+   * @return The number of workers waiting for work
+   */
+  int idle() const { return idle_; }
+
+  void push(const Task& task);
+  int cancel(void* arg);
+  bool runOne();
+
+private:
+
+  /**
+   * The tasks pushed by one thread
+   * 
+   */
+  struct Queue {
+    std::mutex mutex;		/**< Lock of tasks */
+    std::deque<Task> tasks;	/**< Newest at the back */
+  };
+
+  WorkStealingPool();
+  ~WorkStealingPool();
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  void stop();
+  void work(int index);
+
+  static thread_local int index_; /**< Queue of the calling thread */
+
+  std::vector<std::unique_ptr<Queue>> queues_; /**< One per thread */
+  std::vector<std::thread> threads_; /**< The workers */
+  std::atomic<bool> stop_;	     /**< The workers should exit */
+  std::atomic<int> idle_;	     /**< Workers without work */
+  std::atomic<int> pending_;	     /**< Tasks in all queues */
+  std::mutex sleepMutex_;	     /**< Lock for wake_ */
+  std::condition_variable wake_;     /**< Signals a new task or stop_ */
+};
+
+#endif	// WORK_STEALING_POOL_HPP
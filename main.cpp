@@ -38,6 +38,24 @@ void usage(char *prog) {
 	 "  -c, --board_width=N        - board width (N=4,6 or 8, default: 8)\n"
 	 "  -r, --board_height=N       - board height (N=4,6 or 8, default: 8)\n"
 	 "  -A, --prune=N              - use alpha-beta pruning (N=0 or 1, default: 1)\n"
+	 "  -E, --backend=NAME         - search backend (NAME=tree or stack, default: tree)\n"
+	 "  -H, --hash_mb=N            - transposition table size in MB (0 disables it, default: 64)\n"
+	 "  -T, --move_time_ms=N       - time per computer move in ms, searching up to max. depth\n"
+	 "                               by iterative deepening (default: 0, fixed depth)\n"
+	 "  -M, --max_tree_mb=N        - memory limit of the game tree in MB, deleting searched\n"
+	 "                               subtrees when exceeded (default: 0, no limit)\n"
+	 "  -F, --async_free=N         - delete discarded subtrees in a background thread\n"
+	 "                               (N=0 or 1, default: 1)\n"
+	 "  -t, --threads=N            - threads searching the moves of the computer in parallel\n"
+	 "                               (default: 1)\n"
+	 "  -S, --parallel=NAME        - how the threads share the search (NAME=root, ybwc\n"
+	 "                               or lazy, default: ybwc)\n"
+	 "  -a, --algorithm=NAME       - algorithm of the search with pruning (NAME=alphabeta,\n"
+	 "                               pvs or mtdf, default: alphabeta)\n"
+	 "  -e, --endgame_empties=N    - solve the game exactly with N or fewer empty squares\n"
+	 "                               (0 disables, default: 14)\n"
+	 "  -L, --wld=N                - only find the winner when solving, i.e. with --prune=0\n"
+	 "                               and a depth of 128 or more (N=0 or 1, default: 0)\n"
 	 "  -h, --help                 - print this message and quit\n"	 
 	 "NOTES:\n"
 	 "  1. With alpha-beta pruning enabled, i.e. --prune=1, there is no guarantee\n"
@@ -48,6 +66,22 @@ void usage(char *prog) {
 	 "  3. When --prune=0 and --depth=128 or higher is used then minmax algorithm is\n"
 	 "used, which provides a guarantee, given enough time or memory, that the highest\n"
 	 "scoring moves will be selected by the computer.\n"
+	 "  4. The stack backend finds moves of the same value as the tree backend, but\n"
+	 "does not keep the game tree in memory, so it runs in memory proportional to the\n"
+	 "depth. Among moves of equal value, the two backends may choose different ones.\n"
+	 "  5. With --parallel=ybwc, any node of the tree deep enough is split between the\n"
+	 "threads once its first child is searched; --parallel=root only splits the root.\n"
+	 "With --parallel=lazy, every thread searches the whole tree and the threads only\n"
+	 "share the transposition table; this also works with the stack backend.\n"
+	 "  6. --algorithm=pvs searches all moves but the first with a null window, and the\n"
+	 "root with an aspiration window, deepening iteratively (tree backend).\n"
+	 "--algorithm=mtdf converges on the value by null window searches at the root,\n"
+	 "starting from the value of the previous iteration; it needs the transposition table.\n"
+	 "  7. The endgame solver plays perfectly, whatever the depth and the evaluator.\n"
+	 "  8. --wld=1 searches each move with a window around 0 instead of minmax, and stops\n"
+	 "at the first winning move; the outcome with perfect play is printed after each move\n"
+	 "solved. With --move_time_ms, the last iteration solves the outcome if it completes\n"
+	 "in time; otherwise the move is that of a shallower iteration and none is printed.\n"
 	 , prog);
 }
 
@@ -83,10 +117,20 @@ int main(int argc, char **argv)
       {"board_width",         required_argument, 0,  'c' },
       {"board_height",        required_argument, 0,  'r' },
       {"prune",               required_argument, 0,  'A' },
+      {"backend",             required_argument, 0,  'E' },
+      {"hash_mb",             required_argument, 0,  'H' },
+      {"move_time_ms",        required_argument, 0,  'T' },
+      {"max_tree_mb",         required_argument, 0,  'M' },
+      {"async_free",          required_argument, 0,  'F' },
+      {"threads",             required_argument, 0,  't' },
+      {"parallel",            required_argument, 0,  'S' },
+      {"algorithm",           required_argument, 0,  'a' },
+      {"endgame_empties",     required_argument, 0,  'e' },
+      {"wld",                 required_argument, 0,  'L' },
       {"help",                no_argument,       0,  'h' },
       {0,         0,                 0,  0 }
     };
-    c = getopt_long(argc, argv, "d:D:W:B:wbn:PpCc:r:hA:",
+    c = getopt_long(argc, argv, "d:D:W:B:wbn:PpCc:r:hA:E:H:T:M:F:t:S:a:e:L:",
 		    long_options, &option_index);
     if (c == -1)
       break;
@@ -174,6 +218,89 @@ int main(int argc, char **argv)
 	.setPruning(atoi(optarg));
       break;
 
+    case 'E':
+      if( strcmp(optarg, "tree") == 0 ) {
+	MainLoop::getInstance()
+	  .setBackend(SearchTraits::TREE);
+      } else if( strcmp(optarg, "stack") == 0 ) {
+	MainLoop::getInstance()
+	  .setBackend(SearchTraits::STACK);
+      } else {
+	fprintf(stderr, "%s: unknown backend '%s'\n", argv[0], optarg);
+	usage(basename(argv[0]));
+	exit(EXIT_FAILURE);
+      }
+      break;
+
+    case 'H':
+      MainLoop::getInstance()
+	.setHashSize(atoi(optarg));
+      break;
+
+    case 'T':
+      MainLoop::getInstance()
+	.setMoveTime(atoi(optarg));
+      break;
+
+    case 'M':
+      MainLoop::getInstance()
+	.setMaxTreeSize(atoi(optarg));
+      break;
+
+    case 'F':
+      MainLoop::getInstance()
+	.setAsyncFree(atoi(optarg));
+      break;
+
+    case 't':
+      MainLoop::getInstance()
+	.setThreads(atoi(optarg));
+      break;
+
+    case 'S':
+      if( strcmp(optarg, "root") == 0 ) {
+	MainLoop::getInstance()
+	  .setParallel(SearchTraits::ROOT_SPLIT);
+      } else if( strcmp(optarg, "ybwc") == 0 ) {
+	MainLoop::getInstance()
+	  .setParallel(SearchTraits::YBWC);
+      } else if( strcmp(optarg, "lazy") == 0 ) {
+	MainLoop::getInstance()
+	  .setParallel(SearchTraits::LAZY_SMP);
+      } else {
+	fprintf(stderr, "%s: unknown parallel search '%s'\n", argv[0], optarg);
+	usage(basename(argv[0]));
+	exit(EXIT_FAILURE);
+      }
+      break;
+
+    case 'a':
+      if( strcmp(optarg, "alphabeta") == 0 ) {
+	MainLoop::getInstance()
+	  .setAlgorithm(SearchTraits::ALPHABETA);
+      } else if( strcmp(optarg, "pvs") == 0 ) {
+	MainLoop::getInstance()
+	  .setAlgorithm(SearchTraits::PVS);
+      } else if( strcmp(optarg, "mtdf") == 0 ) {
+	MainLoop::getInstance()
+	  .setAlgorithm(SearchTraits::MTDF);
+      } else {
+	fprintf(stderr, "%s: unknown algorithm '%s'\n", argv[0], optarg);
+	usage(basename(argv[0]));
+	exit(EXIT_FAILURE);
+      }
+      break;
+
+    case 'e':
+      MainLoop::getInstance()
+	.setEndgameEmpties(atoi(optarg));
+      break;
+
+    case 'L':
+      MainLoop::getInstance()
+	.setWld(atoi(optarg));
+      break;
+
     case 'h':
       usage(basename(argv[0]));
       exit(EXIT_SUCCESS);
@@ -0,0 +1,252 @@
+/**
+ * @file   othello_solve.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 11:40:55 2026
+ *
+ * @brief  A driver finding the value of the game with perfect play.
+ *
+ *
+ */
+
+#include "Board.hpp"
+#include "StrongSolver.hpp"
+#include "RetrogradeSolver.hpp"
+#include "ProofNumberSolver.hpp"
+#include "TranspositionTable.hpp"
+#include <cstdio>     /* for printf */
+#include <cstdlib>    /* for exit */
+#include <cstring>    /* for basename */
+#include <iostream>
+#include <chrono>
+#include <stdexcept>
+
+
+/* From this point on this is good old-fashioned C */
+
+/**
+ * Produce a usage message.
+ *
+ * @param prog The executable name
+ */
+void usage(char *prog) {
+  printf("Usage: %s [OPTIONS]...\n"
+	 "where OPTIONS may be one of the following:\n"
+	 "  -c, --board_width=N        - board width (N=4,6 or 8, default: 6)\n"
+	 "  -r, --board_height=N       - board height (N=4,6 or 8, default: 6)\n"
+	 "  -H, --hash_mb=N            - transposition table size in MB (default: 1024)\n"
+	 "  -f, --file=PATH            - file of solved positions, read at start and updated\n"
+	 "                               (default: none)\n"
+	 "  -s, --spill_empties=N      - write positions with N or more empty squares to the file\n"
+	 "                               (default: 20)\n"
+	 "  -e, --endgame_empties=N    - use the endgame solver with N or fewer empty squares\n"
+	 "                               (default: 14)\n"
+	 "  -p, --progress_s=N         - seconds between progress reports (default: 60)\n"
+	 "  -S, --solve=NAME           - find the value, or only the winner (NAME=value or wld,\n"
+	 "                               default: value)\n"
+	 "  -R, --retrograde           - solve by layers of positions on disk (default: OFF)\n"
+	 "  -d, --dir=PATH             - directory of the layers of --retrograde (default: .)\n"
+	 "  -m, --sort_mb=N            - memory of a sort of a layer in MB (default: 256)\n"
+	 "  -h, --help                 - print this message and quit\n"
+	 "NOTES:\n"
+	 "  1. The search is depth first, so the memory is that of the transposition table,\n"
+	 "whatever the board. Positions equal up to a symmetry of the board are searched once.\n"
+	 "  2. With --file, a stopped computation resumes from the positions solved so far.\n"
+	 "  3. --retrograde finds the value of every reachable position, keeping a file per\n"
+	 "number of pieces; the memory is --sort_mb, and the disk 24 bytes per position.\n"
+	 "  4. --solve=wld proves the winner by depth-first proof-number search, which needs\n"
+	 "far fewer nodes than the value; it has a table of proof numbers of --hash_mb MB of\n"
+	 "its own, besides the transposition table.\n"
+	 , prog);
+}
+
+
+#include <getopt.h>
+
+/**
+ *
+ *
+ * @param argc
+ * @param argv
+ *
+ * @return
+ */
+int main(int argc, char **argv)
+{
+  int c;
+  int width = 6, height = 6;
+  int hash_mb = 1024;
+  const char* path = "";
+  int spill_empties = 20;
+  int endgame_empties = 14;
+  int progress_s = 60;
+  bool wld = false;
+  bool retrograde = false;
+  const char* dir = ".";
+  int sort_mb = 256;
+  while (1) {
+    int option_index = 0;
+    static struct option long_options[] = {
+      {"board_width",         required_argument, 0,  'c' },
+      {"board_height",        required_argument, 0,  'r' },
+      {"hash_mb",             required_argument, 0,  'H' },
+      {"file",                required_argument, 0,  'f' },
+      {"spill_empties",       required_argument, 0,  's' },
+      {"endgame_empties",     required_argument, 0,  'e' },
+      {"progress_s",          required_argument, 0,  'p' },
+      {"solve",               required_argument, 0,  'S' },
+      {"retrograde",          no_argument,       0,  'R' },
+      {"dir",                 required_argument, 0,  'd' },
+      {"sort_mb",             required_argument, 0,  'm' },
+      {"help",                no_argument,       0,  'h' },
+      {0,         0,                 0,  0 }
+    };
+    c = getopt_long(argc, argv, "c:r:H:f:s:e:p:S:Rd:m:h",
+		    long_options, &option_index);
+    if (c == -1)
+      break;
+
+    switch (c) {
+    case 'c':
+      width = atoi(optarg);
+      break;
+
+    case 'r':
+      height = atoi(optarg);
+      break;
+
+    case 'H':
+      hash_mb = atoi(optarg);
+      break;
+
+    case 'f':
+      path = optarg;
+      break;
+
+    case 's':
+      spill_empties = atoi(optarg);
+      break;
+
+    case 'e':
+      endgame_empties = atoi(optarg);
+      break;
+
+    case 'p':
+      progress_s = atoi(optarg);
+      break;
+
+    case 'S':
+      if( strcmp(optarg, "value") == 0 ) {
+	wld = false;
+      } else if( strcmp(optarg, "wld") == 0 ) {
+	wld = true;
+      } else {
+	fprintf(stderr, "%s: unknown solve mode '%s'\n", argv[0], optarg);
+	usage(basename(argv[0]));
+	exit(EXIT_FAILURE);
+      }
+      break;
+
+    case 'R':
+      retrograde = true;
+      break;
+
+    case 'd':
+      dir = optarg;
+      break;
+
+    case 'm':
+      sort_mb = atoi(optarg);
+      break;
+
+    case 'h':
+      usage(basename(argv[0]));
+      exit(EXIT_SUCCESS);
+      break;
+
+    case ':':
+      /* missing option argument */
+      fprintf(stderr, "%s: option '-%c' requires an argument\n",
+	      argv[0], optopt);
+
+    case '?':
+    default:
+      /* invalid option */
+      usage(basename(argv[0]));
+      exit(EXIT_FAILURE);
+      break;
+    }
+  }
+
+  if (optind < argc) {
+    printf("non-option ARGV-elements: ");
+    while (optind < argc)
+      printf("%s ", argv[optind++]);
+    printf("\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for(int size : {width, height}) {
+    if( size != 4 && size != 6 && size != 8 ) {
+      fprintf(stderr, "%s: unsupported board size %d\n", argv[0], size);
+      exit(EXIT_FAILURE);
+    }
+  }
+  Board::setW(width);
+  Board::setH(height);
+
+  try {
+    if(retrograde) {
+      RetrogradeSolver solver(dir, sort_mb);
+      solver.reportTo(std::cout);
+      const auto start = std::chrono::steady_clock::now();
+      const int value = solver.solve();
+      const auto s = std::chrono::duration_cast<std::chrono::seconds>
+	(std::chrono::steady_clock::now() - start).count();
+      uint64_t positions = 0;
+      for(int tiles = 0; tiles <= width * height; ++tiles) {
+	positions += solver.positions(tiles);
+      }
+      std::cout << "Value of " << width << "x" << height << ": " << value
+		<< ( value > 0 ? ", WHITE wins" : value < 0 ? ", BLACK wins" : ", a DRAW" )
+		<< "\nTime: " << s << " s, positions: " << positions << std::endl;
+      exit(EXIT_SUCCESS);
+    }
+
+    TranspositionTable::getInstance().resize(hash_mb);
+    if(wld) {
+      ProofNumberSolver solver(hash_mb, endgame_empties);
+      solver.reportTo(std::cout, progress_s);
+      const auto start = std::chrono::steady_clock::now();
+      const int winner = solver.wld(Board(), Board::BLACK);
+      const auto s = std::chrono::duration_cast<std::chrono::seconds>
+	(std::chrono::steady_clock::now() - start).count();
+      std::cout << "Winner of " << width << "x" << height << ": "
+		<< ( winner > 0 ? "WHITE" : winner < 0 ? "BLACK" : "none, a DRAW" )
+		<< "\nTime: " << s << " s, nodes: " << solver.nodes()
+		<< ", endgame nodes: " << solver.endgameNodes() << std::endl;
+      TranspositionTable::getInstance().printStats(std::cout);
+      exit(EXIT_SUCCESS);
+    }
+    StrongSolver solver(path, spill_empties, endgame_empties);
+    solver.reportTo(std::cout, progress_s);
+    std::cout << "Solving " << width << "x" << height
+	      << ", positions read from the file: " << solver.stored()
+	      << " (" << solver.solved() << " solved)" << std::endl;
+    const auto start = std::chrono::steady_clock::now();
+    const int value = solver.solve(Board(), Board::BLACK);
+    const auto s = std::chrono::duration_cast<std::chrono::seconds>
+      (std::chrono::steady_clock::now() - start).count();
+    std::cout << "Value of " << width << "x" << height << ": " << value
+	      << ( value > 0 ? ", WHITE wins" : value < 0 ? ", BLACK wins" : ", a DRAW" )
+	      << "\nTime: " << s << " s, nodes: " << solver.nodes()
+	      << ", endgame nodes: " << solver.endgameNodes()
+	      << ", stored positions: " << solver.stored()
+	      << ", solved positions: " << solver.solved() << std::endl;
+    TranspositionTable::getInstance().printStats(std::cout);
+  } catch(std::exception& e) {
+    fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    exit(EXIT_FAILURE);
+  }
+
+  exit(EXIT_SUCCESS);
+}
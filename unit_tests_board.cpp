@@ -9,10 +9,15 @@
  */
 
 #include "Board.hpp"
+#include "unit_tests_fixture.hpp"
 
 #include <iostream>
 #include <cmath>
 #include <iomanip>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <chrono>
 
 #include <boost/test/unit_test.hpp>
 //#include <boost/test/auto_unit_test.hpp>
@@ -92,3 +97,265 @@ BOOST_AUTO_TEST_CASE(board_size)
 }
 
 
+
+/** 
+ * Reference flip computation: walks every ray from (x,y) one square
+ * at a time.
+ * 
+ * @param b 
+ * @param player 
+ * @param x 
+ * @param y 
+ * 
+ * @return Mask of pieces flipped by a move at (x,y)
+ */
+static uint64_t naive_flips(const Board& b, Board::Player player, int x, int y)
+{
+  static const int direction[8][2] = {{0,-1},{1,-1},{1,0},{1,1},{0,1},{-1,1},{-1,0},{-1,-1}};
+  uint64_t mask = 0;
+  for(auto& d : direction) {
+    int tx = x + d[0], ty = y + d[1];
+    uint64_t run = 0;
+    while( tx >= 0 && tx < Board::w() && ty >= 0 && ty < Board::h()
+	   && b.isFilled(tx, ty) && b.isWhite(tx, ty) != (player == Board::WHITE) ) {
+      run |= 1UL << Board::square(tx, ty);
+      tx += d[0]; ty += d[1];
+    }
+    if( tx >= 0 && tx < Board::w() && ty >= 0 && ty < Board::h() && b.isFilled(tx, ty) ) {
+      mask |= run;
+    }
+  }
+  return mask;
+}
+
+/** 
+ * Reference move generator, based on naive_flips().
+ * 
+ * @param b 
+ * @param player 
+ * 
+ * @return Mask of legal moves
+ */
+static uint64_t naive_legal_moves(const Board& b, Board::Player player)
+{
+  uint64_t mask = 0;
+  for(int x = 0; x < Board::w(); ++x) {
+    for(int y = 0; y < Board::h(); ++y) {
+      if( !b.isFilled(x, y) && naive_flips(b, player, x, y) != 0 ) {
+	mask |= 1UL << Board::square(x, y);
+      }
+    }
+  }
+  return mask;
+}
+
+BOOST_FIXTURE_TEST_CASE(board_legal_moves_bitboard, SettingsFixture)
+{
+  // Compare the bitboard generator with the reference on random games
+  // for every supported board size.
+  std::mt19937 gen(2021);
+  for(unsigned w : {4, 6, 8}) {
+    for(unsigned h : {4, 6, 8}) {
+      Board::setW(w);
+      Board::setH(h);
+      for(int game = 0; game < 20; ++game) {
+	Board b;
+	auto player = Board::BLACK;
+	while( b.hasLegalMove(player) || b.hasLegalMove(~player) ) {
+	  BOOST_REQUIRE_EQUAL( b.legalMoves(player), naive_legal_moves(b, player) );
+	  BOOST_REQUIRE_EQUAL( b.legalMoves(~player), naive_legal_moves(b, ~player) );
+	  if( b.hasLegalMove(player) ) {
+	    auto move_bag = b.moves(player);
+	    BOOST_REQUIRE_EQUAL( move_bag.size(), __builtin_popcountl(b.legalMoves(player)) );
+	    std::vector<Board> children;
+	    for( auto& m : move_bag ) {
+	      children.push_back(std::get<2>(m));
+	    }
+	    b = children[gen() % children.size()];
+	  }
+	  player = ~player;
+	}
+      }
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(board_flips_and_play, SettingsFixture)
+{
+  // Compare flips() with the reference and check the effect of play()
+  // on random games for every supported board size.
+  std::mt19937 gen(2021);
+  for(unsigned w : {4, 6, 8}) {
+    for(unsigned h : {4, 6, 8}) {
+      Board::setW(w);
+      Board::setH(h);
+      for(int game = 0; game < 20; ++game) {
+	Board b;
+	auto player = Board::BLACK;
+	while( b.hasLegalMove(player) || b.hasLegalMove(~player) ) {
+	  auto legal = b.legalMoves(player);
+	  std::vector<int> squares;
+	  for(int sq = 0; sq < 64; ++sq) {
+	    int x = sq & 7, y = sq >> 3;
+	    if( x >= Board::w() || y >= Board::h() || b.isFilled(x, y) ) continue;
+	    auto f = b.flips(player, sq);
+	    BOOST_REQUIRE_EQUAL( f, naive_flips(b, player, x, y) );
+	    BOOST_REQUIRE_EQUAL( f != 0, ( legal >> sq ) & 1 );
+	    if( f != 0 ) {
+	      squares.push_back(sq);
+	    }
+	  }
+	  if( !squares.empty() ) {
+	    auto sq = squares[gen() % squares.size()];
+	    Board c(b);
+	    auto f = c.play(player, sq);
+	    int sign = ( player == Board::WHITE ) ? 1 : -1;
+	    BOOST_REQUIRE_EQUAL( c.numTiles(), b.numTiles() + 1 );
+	    BOOST_REQUIRE_EQUAL( c.score(), b.score() + sign * ( 2 * __builtin_popcountl(f) + 1 ) );
+	    BOOST_REQUIRE_EQUAL( c.score(player), b.score(player) + 2 * __builtin_popcountl(f) + 1 );
+	    BOOST_REQUIRE_EQUAL( c.score(~player), -c.score(player) );
+	    BOOST_REQUIRE( c.isFilled(sq & 7, sq >> 3) );
+	    BOOST_REQUIRE_EQUAL( c.isWhite(sq & 7, sq >> 3), player == Board::WHITE );
+	    b = c;
+	  }
+	  player = ~player;
+	}
+      }
+    }
+  }
+}
+
+/** 
+ * Collect all positions reachable from a board.
+ * 
+ * @param b 
+ * @param player The player to move
+ * @param positions All positions found so far
+ */
+static void collect_positions(const Board& b, Board::Player player,
+			      std::vector<std::pair<Board, Board::Player>>& positions)
+{
+  positions.emplace_back(b, player);
+  if( b.hasLegalMove(player) ) {
+    for( auto& [x, y, c] : b.moves(player) ) {
+      collect_positions(c, ~player, positions);
+    }
+  } else if( b.hasLegalMove(~player) ) {
+    collect_positions(b, ~player, positions);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(board_hash_collisions, SettingsFixture)
+{
+  // Hash every position of the 4x4 game tree; equal hashes must
+  // come from equal positions
+  Board::setW(4);
+  Board::setH(4);
+  std::vector<std::pair<Board, Board::Player>> positions;
+  collect_positions(Board(), Board::BLACK, positions);
+  std::sort(positions.begin(), positions.end(),
+	    [](const auto& a, const auto& b) {
+	      return a.first.hash(a.second) < b.first.hash(b.second);
+	    });
+  size_t distinct = 1;
+  for(size_t i = 1; i < positions.size(); ++i) {
+    const auto& [b0, p0] = positions[i-1];
+    const auto& [b1, p1] = positions[i];
+    if( b0.hash(p0) == b1.hash(p1) ) {
+      BOOST_REQUIRE( b0 == b1 && p0 == p1 );
+    } else {
+      ++distinct;
+    }
+  }
+  std::cout << boost::format("4x4 tree nodes: %u, distinct positions: %u\n")
+    % positions.size() % distinct;
+}
+
+BOOST_AUTO_TEST_CASE(board_hash_benchmark)
+{
+  std::mt19937 gen(2021);
+  std::vector<Board> boards;
+  Board b;
+  auto player = Board::BLACK;
+  while( boards.size() < 1024 ) {
+    boards.push_back(b);
+    auto move_bag = b.moves(player);
+    if( move_bag.empty() ) {
+      b = Board();
+      player = Board::BLACK;
+    } else {
+      b = std::get<2>(move_bag[gen() % move_bag.size()]);
+      player = ~player;
+    }
+  }
+  const int rounds = 10000;
+  uint64_t acc = 0;
+  auto start = std::chrono::steady_clock::now();
+  for(int r = 0; r < rounds; ++r) {
+    for(const auto& board : boards) {
+      acc += board.hash(( r & 1 ) ? Board::WHITE : Board::BLACK);
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << boost::format("Board::hash(): %.2f ns per call (checksum %x)\n")
+    % ( elapsed.count() / rounds / boards.size() ) % acc;
+}
+
+BOOST_FIXTURE_TEST_CASE(board_canonical, SettingsFixture)
+{
+  std::mt19937 gen(23);
+  const std::pair<int, int> sizes[] = { {4, 4}, {6, 4}, {4, 6}, {6, 6}, {8, 6}, {8, 8} };
+  for(const auto& size : sizes) {
+    Board::setW(size.first);
+    Board::setH(size.second);
+    const int w = size.first, h = size.second;
+    BOOST_CHECK_EQUAL( Board::numTransforms(), ( w == h ) ? 8 : 4 );
+
+    // The first moves are all equivalent on a square board; otherwise
+    // only the rotation by 180 degrees keeps the initial position
+    const Board initial;
+    const auto opening = initial.moves(Board::BLACK);
+    BOOST_CHECK_EQUAL( opening.size(), 4 );
+    std::vector<uint64_t> classes;
+    for(const auto& move : opening) {
+      classes.push_back(std::get<2>(move).canonical().first.hash(Board::WHITE));
+    }
+    std::sort(classes.begin(), classes.end());
+    classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+    BOOST_CHECK_EQUAL( classes.size(), ( w == h ) ? 1 : 2 );
+
+    for(int game = 0; game < 10; ++game) {
+      Board b;
+      auto player = Board::BLACK;
+      while( b.hasLegalMove(player) || b.hasLegalMove(~player) ) {
+	const auto canon = b.canonical();
+	BOOST_CHECK( b.transformed(canon.second) == canon.first );
+	BOOST_CHECK( canon.first.canonical().first == canon.first );
+	for(int t = 0; t < Board::numTransforms(); ++t) {
+	  const Board image = b.transformed(t);
+	  BOOST_REQUIRE( image.canonical().first == canon.first );
+	  BOOST_REQUIRE( image.transformed(Board::inverse(t)) == b );
+	  BOOST_REQUIRE_EQUAL( image.score(), b.score() );
+	  uint64_t moves = 0;
+	  for(uint64_t m = b.legalMoves(player); m != 0; m &= m - 1) {
+	    moves |= uint64_t(1) << Board::transform(Board::bitscan(m), t);
+	  }
+	  BOOST_REQUIRE_EQUAL( image.legalMoves(player), moves );
+	  for(int y = 0; y < h; ++y) {
+	    for(int x = 0; x < w; ++x) {
+	      const uint8_t sq = Board::transform(Board::square(x, y), t);
+	      BOOST_REQUIRE_EQUAL( Board::transform(sq, Board::inverse(t)), Board::square(x, y) );
+	      BOOST_REQUIRE_EQUAL( image.isFilled(sq & 7, sq >> 3), b.isFilled(x, y) );
+	      BOOST_REQUIRE_EQUAL( image.isWhite(sq & 7, sq >> 3), b.isWhite(x, y) );
+	    }
+	  }
+	}
+	auto move_bag = b.moves(player);
+	if( !move_bag.empty() ) {
+	  b = std::get<2>(move_bag[gen() % move_bag.size()]);
+	}
+	player = ~player;
+      }
+    }
+  }
+}
@@ -0,0 +1,132 @@
+/**
+ * @file   unit_tests_endgame.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 09:42:08 2026
+ *
+ * @brief  Unit tests according to the Boost unit testing framework
+ *
+ *
+ */
+
+#include "EndgameSolver.hpp"
+#include "Search.hpp"
+#include "TreeNode.hpp"
+#include "SimpleStaticEvaluator.hpp"
+#include "CornerStaticEvaluator.hpp"
+#include "TranspositionTable.hpp"
+#include "unit_tests_fixture.hpp"
+
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <chrono>
+
+#include <boost/test/unit_test.hpp>
+
+/**
+ * Play random moves from the initial position until a number of
+ * squares is left empty, or the game ends.
+ *
+ * @param gen Random number generator
+ * @param empties
+ * @param player Set to the player to move
+ *
+ * @return The board after the moves
+ */
+static Board random_endgame(std::mt19937& gen, int empties, Board::Player& player)
+{
+  Board b;
+  player = Board::BLACK;
+  while( Board::w() * Board::h() - b.numTiles() > empties
+	 && ( b.hasLegalMove(player) || b.hasLegalMove(~player) ) ) {
+    auto move_bag = b.moves(player);
+    if( !move_bag.empty() ) {
+      b = std::get<2>(move_bag[gen() % move_bag.size()]);
+    }
+    player = ~player;
+  }
+  return b;
+}
+
+BOOST_FIXTURE_TEST_CASE(endgame_matches_search, SettingsFixture)
+{
+  // The solver finds the values and best moves of a search to the end
+  Board::setW(6);
+  Board::setH(6);
+  std::mt19937 gen(20261017);
+  SimpleStaticEvaluator evaluator;
+  for(int empties = 0; empties <= 12; ++empties) {
+    for(int k = 0; k < 5; ++k) {
+      Board::Player player;
+      const Board b = random_endgame(gen, empties, player);
+      const int depth = 2 * empties + 2;
+      Search search(evaluator, true);
+      EndgameSolver solver;
+      BOOST_REQUIRE_EQUAL( int(solver.value(b, player)), int(search.value(b, player, depth)) );
+      if( b.hasLegalMove(player) ) {
+	auto solverBest = solver.bestMoves(b, player);
+	auto searchBest = search.bestMoves(b, player, depth);
+	std::sort(solverBest.begin(), solverBest.end());
+	std::sort(searchBest.begin(), searchBest.end());
+	BOOST_REQUIRE( std::equal(solverBest.begin(), solverBest.end(),
+				  searchBest.begin(), searchBest.end()) );
+      }
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(endgame_8x8, SettingsFixture)
+{
+  // The solver is much faster than a search to the end
+  Board::setW(8);
+  Board::setH(8);
+  std::mt19937 gen(1017);
+  SimpleStaticEvaluator evaluator;
+  for(int empties : {10, 14}) {
+    Board::Player player;
+    const Board b = random_endgame(gen, empties, player);
+    TranspositionTable::getInstance().clear();
+    EndgameSolver solver;
+    auto start = std::chrono::steady_clock::now();
+    const int value = solver.value(b, player);
+    const auto solverMs = std::chrono::duration_cast<std::chrono::milliseconds>
+      (std::chrono::steady_clock::now() - start).count();
+    TranspositionTable::getInstance().clear();
+    Search search(evaluator, true);
+    start = std::chrono::steady_clock::now();
+    BOOST_CHECK_EQUAL( value, int(search.value(b, player, 2 * empties + 2)) );
+    const auto searchMs = std::chrono::duration_cast<std::chrono::milliseconds>
+      (std::chrono::steady_clock::now() - start).count();
+    std::cout << "Empties: " << empties << ", value: " << value
+	      << ", solver nodes: " << solver.nodes() << " (" << solverMs << " ms)"
+	      << ", search nodes: " << search.nodes() << " (" << searchMs << " ms)\n";
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(endgame_computer_move, SettingsFixture)
+{
+  // getComputerMove() solves the endgame below the threshold
+  Board::setW(8);
+  Board::setH(8);
+  std::mt19937 gen(17);
+  CornerStaticEvaluator evaluator;
+  const StaticEvaluatorTable evaluatorTab = { &evaluator, &evaluator };
+  TreeNode::endgame_empties = 12;
+  for(auto backend : {SearchTraits::TREE, SearchTraits::STACK}) {
+    TreeNode::backend = backend;
+    Board::Player player;
+    Board b = random_endgame(gen, 12, player);
+    if( !b.hasLegalMove(player) ) {
+      player = ~player;
+    }
+    BOOST_REQUIRE( b.hasLegalMove(player) );
+    const int empties = Board::w() * Board::h() - b.numTiles();
+    TreeNode root(player, b);
+    const TreeNode child = root.getComputerMove(evaluatorTab, 2, true);
+    BOOST_CHECK_EQUAL( TreeNode::search_depth, empties );
+    // The move keeps the exact value
+    EndgameSolver solver;
+    BOOST_CHECK_EQUAL( solver.value(child.board(), child.player()), solver.value(b, player) );
+    BOOST_CHECK_EQUAL( int(child.minMaxVal()), int(solver.value(b, player)) );
+  }
+}
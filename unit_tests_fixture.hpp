@@ -0,0 +1,93 @@
+/**
+ * @file   unit_tests_fixture.hpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 18:04:27 2026
+ *
+ * @brief  Fixture of the unit tests which change the global settings
+ *
+ *
+ */
+
+#ifndef UNIT_TESTS_FIXTURE_HPP
+#define UNIT_TESTS_FIXTURE_HPP
+
+#include "Board.hpp"
+#include "TreeNode.hpp"
+#include "TranspositionTable.hpp"
+#include "MoveOrdering.hpp"
+#include "Reclaimer.hpp"
+
+/**
+ * Saves the settings shared by all tests when a test starts, and
+ * restores them when it ends, even if a BOOST_REQUIRE fails: the size
+ * of the board, the settings of the search of TreeNode, the move
+ * ordering heuristics and Reclaimer::async. The transposition table is
+ * cleared at both ends, and resized back if the test resized it.
+ *
+ * Use with BOOST_FIXTURE_TEST_CASE.
+ */
+struct SettingsFixture {
+  SettingsFixture()
+    : w(Board::w()),
+      h(Board::h()),
+      print_recursively(TreeNode::print_recursively),
+      backend(TreeNode::backend),
+      move_time_ms(TreeNode::move_time_ms),
+      max_nodes(TreeNode::max_nodes),
+      threads(TreeNode::threads),
+      parallel(TreeNode::parallel),
+      min_split_depth(TreeNode::min_split_depth),
+      algorithm(TreeNode::algorithm),
+      aspiration_window(TreeNode::aspiration_window),
+      endgame_empties(TreeNode::endgame_empties),
+      wld(TreeNode::wld),
+      heuristics(MoveOrdering::getInstance().heuristics),
+      async(Reclaimer::async),
+      table_bytes(TranspositionTable::getInstance().bytes())
+  {
+    TranspositionTable::getInstance().clear();
+  }
+
+  ~SettingsFixture()
+  {
+    Board::setW(w);
+    Board::setH(h);
+    TreeNode::print_recursively = print_recursively;
+    TreeNode::backend = backend;
+    TreeNode::move_time_ms = move_time_ms;
+    TreeNode::max_nodes = max_nodes;
+    TreeNode::threads = threads;
+    TreeNode::parallel = parallel;
+    TreeNode::min_split_depth = min_split_depth;
+    TreeNode::algorithm = algorithm;
+    TreeNode::aspiration_window = aspiration_window;
+    TreeNode::endgame_empties = endgame_empties;
+    TreeNode::wld = wld;
+    MoveOrdering::getInstance().heuristics = heuristics;
+    Reclaimer::async = async;
+    auto& table = TranspositionTable::getInstance();
+    if(table.bytes() != table_bytes) {
+      table.resize(table_bytes >> 20);
+    }
+    table.clear();
+  }
+
+  const uint8_t w;		/**< See Board::w() */
+  const uint8_t h;		/**< See Board::h() */
+  const bool print_recursively;	/**< See TreeNode */
+  const TreeNode::Backend backend; /**< See TreeNode */
+  const int move_time_ms;	/**< See TreeNode */
+  const size_t max_nodes;	/**< See TreeNode */
+  const int threads;		/**< See TreeNode */
+  const TreeNode::Parallel parallel; /**< See TreeNode */
+  const int min_split_depth;	/**< See TreeNode */
+  const TreeNode::Algorithm algorithm; /**< See TreeNode */
+  const int aspiration_window;	/**< See TreeNode */
+  const int endgame_empties;	/**< See TreeNode */
+  const bool wld;		/**< See TreeNode */
+  const unsigned heuristics;	/**< See MoveOrdering */
+  const bool async;		/**< See Reclaimer */
+  const size_t table_bytes;	/**< See TranspositionTable::bytes() */
+};
+
+#endif	// UNIT_TESTS_FIXTURE_HPP
@@ -21,7 +21,10 @@
 
 BOOST_AUTO_TEST_CASE(main_loop_test)
 {
+  // The 4x6 board, which this test used to get from the tests before it
   MainLoop::getInstance()
+    .setBoardWidth(4)
+    .setBoardHeight(6)
     .setMaxDepth(BoardTraits::WHITE, 12)
     .setMaxDepth(BoardTraits::BLACK, 12)  
     .setNumGames(1)
@@ -80,3 +83,21 @@ BOOST_AUTO_TEST_CASE(solution_attempt_6x4)
     .setNumGames(1)
     .run();
 }
+
+BOOST_AUTO_TEST_CASE(stack_backend_6x6)
+{
+  const int depth = 8;
+  std::cout << "Stack backend, the 6x6 case, depth " << depth << std::endl;
+
+  MainLoop::getInstance()
+    .setBoardWidth(6)
+    .setBoardHeight(6)
+    .setPruning(1)
+    .setBackend(SearchTraits::STACK)
+    .setMaxDepth(BoardTraits::WHITE, depth)
+    .setMaxDepth(BoardTraits::BLACK, depth)  
+    .setNumGames(1)
+    .run();
+  MainLoop::getInstance()
+    .setBackend(SearchTraits::TREE);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file   unit_tests_search.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Fri Oct 16 11:48:26 2026
+ * 
+ * @brief  Unit tests according to the Boost unit testing framework
+ * 
+ * 
+ */
+
+#include "Search.hpp"
+#include "TreeNode.hpp"
+#include "SimpleStaticEvaluator.hpp"
+#include "CornerStaticEvaluator.hpp"
+#include "unit_tests_fixture.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/format.hpp>
+
+/** 
+ * Play a number of random moves from the initial position.
+ * 
+ * @param gen Random number generator
+ * @param numMoves 
+ * @param player Set to the player to move
+ * 
+ * @return The board after the moves
+ */
+static Board random_board(std::mt19937& gen, int numMoves, Board::Player& player)
+{
+  Board b;
+  player = Board::BLACK;
+  for(int i = 0; i < numMoves && ( b.hasLegalMove(player) || b.hasLegalMove(~player) ); ++i) {
+    auto move_bag = b.moves(player);
+    if( !move_bag.empty() ) {
+      b = std::get<2>(move_bag[gen() % move_bag.size()]);
+    }
+    player = ~player;
+  }
+  return b;
+}
+
+/** 
+ * Compare the values and best moves of Search with those of TreeNode.
+ * 
+ * @param w Board width
+ * @param h Board height
+ * @param depth 
+ * @param evaluator 
+ */
+static void compare_with_tree(unsigned w, unsigned h, int depth, const StaticEvaluator& evaluator)
+{
+  Board::setW(w);
+  Board::setH(h);
+  std::mt19937 gen(w * 10 + h);
+  for(int pos = 0; pos < 8; ++pos) {
+    Board::Player player;
+    auto b = random_board(gen, 2 * pos, player);
+    for(bool prune : {false, true}) {
+      TreeNode root(player, b);
+      if( root.isLeaf() ) continue;
+      root.alphabeta(evaluator, depth, prune);
+      Search search(evaluator, prune);
+      BOOST_REQUIRE_EQUAL( search.value(b, player, depth), root.minMaxVal() );
+
+      if(!prune) {		// Children values are exact
+	std::vector<int> treeBest;
+	for(auto child : root.children()) {
+	  if( child->minMaxVal() == root.minMaxVal() && child->x() >= 0 ) {
+	    treeBest.push_back(Board::square(child->x(), child->y()));
+	  }
+	}
+	for(bool p : {false, true}) {
+	  Search s(evaluator, p);
+	  auto best = s.bestMoves(b, player, depth);
+	  std::vector<int> stackBest(best.begin(), best.end());
+	  std::sort(treeBest.begin(), treeBest.end());
+	  std::sort(stackBest.begin(), stackBest.end());
+	  BOOST_REQUIRE( treeBest == stackBest );
+	}
+      }
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(search_matches_tree, SettingsFixture)
+{
+  SimpleStaticEvaluator simple;
+  CornerStaticEvaluator corner;
+  compare_with_tree(8, 8, 4, simple);
+  compare_with_tree(8, 8, 4, corner);
+  compare_with_tree(6, 6, 5, simple);
+  compare_with_tree(4, 6, 6, corner);
+  compare_with_tree(6, 4, 6, simple);
+  compare_with_tree(4, 4, 12, simple);
+}
+
+BOOST_FIXTURE_TEST_CASE(search_solve_4x4, SettingsFixture)
+{
+  Board::setW(4);
+  Board::setH(4);
+  TreeNode root;
+  root.minmax();
+  SimpleStaticEvaluator evaluator;
+  Search search(evaluator, true);
+  auto val = search.value(Board(), Board::BLACK, 128);
+  std::cout << boost::format("4x4 value: %d, nodes: %u\n") % int(val) % search.nodes();
+  BOOST_CHECK_EQUAL( val, root.minMaxVal() );
+}
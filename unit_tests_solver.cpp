@@ -0,0 +1,148 @@
+/**
+ * @file   unit_tests_solver.cpp
+ * @author Marek Rychlik <marek@cannonball.lan>
+ * @date   Sat Oct 17 12:20:41 2026
+ *
+ * @brief  Unit tests according to the Boost unit testing framework
+ *
+ *
+ */
+
+#include "StrongSolver.hpp"
+#include "RetrogradeSolver.hpp"
+#include "ProofNumberSolver.hpp"
+#include "EndgameSolver.hpp"
+#include "TreeNode.hpp"
+#include "TranspositionTable.hpp"
+#include "unit_tests_fixture.hpp"
+
+#include <iostream>
+#include <random>
+#include <cstdio>
+#include <filesystem>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_CASE(solver_small_boards, SettingsFixture)
+{
+  // The values of the whole game, as found by minmax() and the endgame solver
+  Board::setW(4);
+  Board::setH(4);
+  TreeNode root;
+  root.minmax();
+  TranspositionTable::getInstance().clear();
+  StrongSolver solver4x4("", 20, 4);
+  BOOST_CHECK_EQUAL( int(solver4x4.solve(Board(), Board::BLACK)), int(root.minMaxVal()) );
+
+  for(auto size : { std::pair(6, 4), std::pair(4, 6) }) {
+    Board::setW(size.first);
+    Board::setH(size.second);
+    TranspositionTable::getInstance().clear();
+    StrongSolver solver("", 20, 8);
+    const int value = solver.solve(Board(), Board::BLACK);
+    std::cout << size.first << "x" << size.second << " value: " << value
+	      << ", nodes: " << solver.nodes() << ", endgame nodes: " << solver.endgameNodes() << "\n";
+    EndgameSolver endgame;
+    BOOST_CHECK_EQUAL( value, int(endgame.value(Board(), Board::BLACK)) );
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(solver_file, SettingsFixture)
+{
+  // A second run reads the positions solved by the first one
+  Board::setW(6);
+  Board::setH(4);
+  const std::string path = ( std::filesystem::temp_directory_path() / "unit_tests_solver.dat" ).string();
+  std::remove(path.c_str());
+  int value[2];
+  uint64_t nodes[2], stored[2];
+  for(int run = 0; run < 2; ++run) {
+    TranspositionTable::getInstance().clear();
+    StrongSolver solver(path, 10, 8);
+    BOOST_CHECK_EQUAL( solver.stored(), run > 0 ? stored[0] : 0 );
+    value[run] = solver.solve(Board(), Board::BLACK);
+    nodes[run] = solver.nodes();
+    stored[run] = solver.stored();
+    BOOST_CHECK( solver.solved() > 0 );
+    // The hash table of the file, doubled from 1024 slots, is at most half full
+    const uint64_t slots = std::filesystem::file_size(path) / 24 - 1;
+    std::cout << "Stored positions: " << stored[run] << ", slots of the file: " << slots << "\n";
+    BOOST_CHECK( slots > 1024 && 2 * stored[run] <= slots );
+  }
+  BOOST_CHECK_EQUAL( value[0], value[1] );
+  BOOST_CHECK_EQUAL( stored[0], stored[1] );
+  BOOST_CHECK( nodes[1] < nodes[0] );
+  std::remove(path.c_str());
+}
+
+BOOST_FIXTURE_TEST_CASE(solver_retrograde, SettingsFixture)
+{
+  // The layers give the value of any position reachable from the initial one
+  Board::setW(4);
+  Board::setH(4);
+  const std::string dir = ( std::filesystem::temp_directory_path() / "unit_tests_retrograde" ).string();
+  std::mt19937 gen(22);
+  EndgameSolver endgame;
+  for(size_t sort_bytes : {4096, 256 << 20}) {	// Runs of 128 to 256 records, or one run
+    RetrogradeSolver solver(dir);
+    solver.setSortBytes(sort_bytes);
+    BOOST_CHECK_EQUAL( int(solver.solve()), 8 );
+    BOOST_CHECK_EQUAL( solver.positions(4), 1 );
+    BOOST_CHECK_EQUAL( solver.positions(16), 814 );
+    for(int k = 0; k < 20; ++k) {
+      Board b;
+      Board::Player player = Board::BLACK;
+      while( b.hasLegalMove(player) || b.hasLegalMove(~player) ) {
+	BOOST_REQUIRE_EQUAL( int(solver.value(b, player)), int(endgame.value(b, player)) );
+	auto move_bag = b.moves(player);
+	if( !move_bag.empty() ) {
+	  b = std::get<2>(move_bag[gen() % move_bag.size()]);
+	}
+	player = ~player;
+      }
+      BOOST_REQUIRE_EQUAL( int(solver.value(b, player)), b.score() );
+    }
+  }
+  std::filesystem::remove_all(dir);
+}
+
+BOOST_FIXTURE_TEST_CASE(solver_wld, SettingsFixture)
+{
+  // The winner is proved with fewer nodes than the value takes
+  for(auto size : { std::pair(4, 4), std::pair(6, 4), std::pair(4, 6) }) {
+    Board::setW(size.first);
+    Board::setH(size.second);
+    TranspositionTable::getInstance().clear();
+    StrongSolver strong("", 20, 8);
+    const int value = strong.solve(Board(), Board::BLACK);
+    ProofNumberSolver solver(16, 8);
+    BOOST_CHECK_EQUAL( solver.wld(Board(), Board::BLACK), ( value > 0 ) - ( value < 0 ) );
+    std::cout << size.first << "x" << size.second << " df-pn nodes: " << solver.nodes()
+	      << ", endgame nodes: " << solver.endgameNodes()
+	      << "; value nodes: " << strong.nodes() << ", endgame nodes: " << strong.endgameNodes() << "\n";
+    BOOST_CHECK( solver.nodes() + solver.endgameNodes() < strong.nodes() + strong.endgameNodes() );
+  }
+
+  // The goal is a score above the threshold
+  Board::setW(6);
+  Board::setH(6);
+  std::mt19937 gen(24);
+  EndgameSolver endgame;
+  for(int k = 0; k < 10; ++k) {
+    Board b;
+    Board::Player player = Board::BLACK;
+    while( Board::w() * Board::h() - b.numTiles() > 16 ) {
+      auto move_bag = b.moves(player);
+      if( !move_bag.empty() ) {
+	b = std::get<2>(move_bag[gen() % move_bag.size()]);
+      }
+      player = ~player;
+    }
+    const int value = endgame.value(b, player);
+    const int own = ( player == Board::WHITE ) ? value : -value;
+    ProofNumberSolver solver(16, 6);
+    BOOST_CHECK( solver.proves(b, player, own - 1) );
+    BOOST_CHECK( !solver.proves(b, player, own) );
+    BOOST_CHECK_EQUAL( solver.wld(b, player), ( value > 0 ) - ( value < 0 ) );
+  }
+}
@@ -12,11 +12,22 @@
 #include "SimpleStaticEvaluator.hpp"
 #include "CornerStaticEvaluator.hpp"
 #include "StaticEvaluator.hpp"
+#include "TranspositionTable.hpp"
+#include "EndgameSolver.hpp"
+#include "MoveOrdering.hpp"
+#include "NodeArena.hpp"
+#include "Reclaimer.hpp"
+#include "Search.hpp"
+#include "unit_tests_fixture.hpp"
 
 #include <memory>
 #include <iostream>
 #include <cmath>
 #include <iomanip>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <future>
 
 #include <boost/test/unit_test.hpp>
 //#include <boost/test/auto_unit_test.hpp>
@@ -27,6 +38,9 @@ BOOST_AUTO_TEST_CASE(tree_node_size)
 {
   TreeNode root;
   std::cout << "TreeNode size: " << sizeof(root) << std::endl;
+  // Board, 32-bit index of the children, bits
+  BOOST_CHECK_EQUAL( sizeof(root), sizeof(Board) + 8 );
+  BOOST_CHECK_EQUAL( sizeof(root), 24 );
 }
 
 BOOST_AUTO_TEST_CASE(tree_alphabeta_and_print)
@@ -96,27 +110,27 @@ static void node_count(unsigned w, unsigned h, int max_depth)
   }
 }
 
-BOOST_AUTO_TEST_CASE(tree_node_count)
+BOOST_FIXTURE_TEST_CASE(tree_node_count, SettingsFixture)
 {
   node_count(8, 8, 11);
 }
 
-BOOST_AUTO_TEST_CASE(tree_node_count_4x4)
+BOOST_FIXTURE_TEST_CASE(tree_node_count_4x4, SettingsFixture)
 {
   node_count(4, 4, 20);
 }
 
-BOOST_AUTO_TEST_CASE(tree_node_count_6x6)
+BOOST_FIXTURE_TEST_CASE(tree_node_count_6x6, SettingsFixture)
 {
   node_count(6, 6, 10);
 }
 
-BOOST_AUTO_TEST_CASE(tree_node_count_6x4)
+BOOST_FIXTURE_TEST_CASE(tree_node_count_6x4, SettingsFixture)
 {
   node_count(6, 4, 12);
 }
 
-BOOST_AUTO_TEST_CASE(tree_node_count_4x6)
+BOOST_FIXTURE_TEST_CASE(tree_node_count_4x6, SettingsFixture)
 {
   node_count(4, 6, 12);
 }
@@ -157,3 +171,592 @@ BOOST_AUTO_TEST_CASE(tree_copy_assign_nothrow_level_2)
   //BOOST_CHECK_NO_THROW (expression)
   BOOST_REQUIRE_NO_THROW( t1 = std::move(*t3) );
 }
+
+BOOST_FIXTURE_TEST_CASE(transposition_table_replacement, SettingsFixture)
+{
+  auto& table = TranspositionTable::getInstance();
+  table.resize(1);
+  TranspositionTable::Entry e;
+  BOOST_CHECK( !table.probe(42, e) );
+  table.store(42, -3, TranspositionTable::LOWER, 7, 19);
+  BOOST_REQUIRE( table.probe(42, e) );
+  BOOST_CHECK_EQUAL( e.value, -3 );
+  BOOST_CHECK_EQUAL( e.bound, TranspositionTable::LOWER );
+  BOOST_CHECK_EQUAL( e.depth, 7 );
+  BOOST_CHECK_EQUAL( e.move, 19 );
+
+  // Keys differing in the high bits share a bucket. The three
+  // deepest results stay, the last shallow one is kept as well.
+  const uint64_t step = 1UL << 40;
+  for(int i = 1; i <= 5; ++i) {
+    table.store(42 + i * step, i, TranspositionTable::EXACT, 10 + i, 0);
+  }
+  table.store(42 + 6 * step, 6, TranspositionTable::EXACT, 1, 0);
+  for(int i = 3; i <= 6; ++i) {
+    BOOST_CHECK( table.probe(42 + i * step, e) );
+  }
+  BOOST_CHECK( !table.probe(42, e) );
+  BOOST_CHECK( !table.probe(42 + step, e) );
+}
+
+BOOST_FIXTURE_TEST_CASE(transposition_table_board_size, SettingsFixture)
+{
+  // A position has another key on a board of another size, where it
+  // has other moves
+  SimpleStaticEvaluator evaluator;
+  Board::setW(4);
+  Board::setH(4);
+  const Board board;
+  const uint64_t key = TranspositionTable::key(board.hash(Board::BLACK), evaluator);
+  for(auto size : { std::pair(4, 6), std::pair(6, 4), std::pair(6, 6) }) {
+    Board::setW(size.first);
+    Board::setH(size.second);
+    BOOST_CHECK( TranspositionTable::key(board.hash(Board::BLACK), evaluator) != key );
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_transposition_table, SettingsFixture)
+{
+  // The table must not change any value
+  Board::setW(6);
+  Board::setH(6);
+  SimpleStaticEvaluator evaluator;
+  auto& table = TranspositionTable::getInstance();
+  for(bool prune : {false, true}) {
+    table.resize(0);
+    TreeNode t1;
+    t1.alphabeta(evaluator, 7, prune);
+    table.resize(TranspositionTable::DEFAULT_SIZE_MB);
+    TreeNode t2;
+    t2.alphabeta(evaluator, 7, prune);
+    BOOST_CHECK_EQUAL( t1.minMaxVal(), t2.minMaxVal() );
+    table.printStats(std::cout);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_move_ordering, SettingsFixture)
+{
+  // Ordering changes the nodes searched, not the value
+  Board::setW(6);
+  Board::setH(6);
+  SimpleStaticEvaluator evaluator;
+  auto& ordering = MoveOrdering::getInstance();
+  int value[2];
+  for(unsigned heuristics : {0, int(MoveOrdering::ALL)}) {
+    TranspositionTable::getInstance().clear();
+    ordering.clear();
+    ordering.heuristics = heuristics;
+    TreeNode root;
+    root.alphabeta(evaluator, 9, true);
+    value[heuristics != 0] = root.minMaxVal();
+    std::cout << "Heuristics: " << heuristics << ", value: " << int(root.minMaxVal()) << "\n";
+    ordering.printStats(std::cout);
+  }
+  BOOST_CHECK_EQUAL( value[0], value[1] );
+}
+
+BOOST_AUTO_TEST_CASE(move_ordering_threads)
+{
+  // The counters of all threads are summed, also after a thread exits,
+  // and cleared together
+  MoveOrdering::clearAll();
+  std::promise<void> counted, cleared;
+  uint64_t left = 1;		// By clearAll(), in the worker
+  std::thread worker([&] {
+    auto& ordering = MoveOrdering::getInstance();
+    for(int i = 0; i < 3; ++i) {
+      ordering.countNode();
+    }
+    counted.set_value();
+    cleared.get_future().wait();
+    left = ordering.stats().nodes;
+    ordering.countNode();
+  });
+  counted.get_future().wait();
+  BOOST_CHECK_EQUAL( MoveOrdering::allStats().nodes, 3 );
+  MoveOrdering::clearAll();
+  BOOST_CHECK_EQUAL( MoveOrdering::allStats().nodes, 0 );
+  cleared.set_value();
+  worker.join();
+  BOOST_CHECK_EQUAL( left, 0 );
+  BOOST_CHECK_EQUAL( MoveOrdering::allStats().nodes, 1 );
+  MoveOrdering::clearAll();
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_move_time, SettingsFixture)
+{
+  // A deep search is cut short by the time budget
+  Board::setW(8);
+  Board::setH(8);
+  SimpleStaticEvaluator evaluator;
+  const StaticEvaluatorTable evaluatorTab = { &evaluator, &evaluator };
+  const int depth = 30;
+  TreeNode::move_time_ms = 200;
+  for(auto backend : {SearchTraits::TREE, SearchTraits::STACK}) {
+    TreeNode::backend = backend;
+    TreeNode root;
+    const auto start = std::chrono::steady_clock::now();
+    TreeNode child = root.getComputerMove(evaluatorTab, depth, true);
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>
+      (std::chrono::steady_clock::now() - start).count();
+    std::cout << "Backend: " << backend << ", depth reached: " << TreeNode::search_depth
+	      << ", time: " << ms << " ms\n";
+    BOOST_CHECK( TreeNode::search_depth >= 1 && TreeNode::search_depth < depth );
+    BOOST_CHECK( ms < 1000 );
+    BOOST_CHECK_EQUAL( child.board().numTiles(), 5 );
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_node_arena, SettingsFixture)
+{
+  // All nodes but the root come from the arena and go back to it
+  Board::setW(6);
+  Board::setH(6);
+  auto& arena = NodeArena<TreeNode>::getInstance();
+  const auto live = arena.stats().live;
+  arena.resetPeak();
+  {
+    TreeNode root;
+    const auto start = std::chrono::steady_clock::now();
+    const int count = root.nodeCount(8);
+    const auto expanded = std::chrono::steady_clock::now();
+    BOOST_CHECK_EQUAL( arena.stats().live, live + count - 1 );
+    BOOST_CHECK_EQUAL( arena.stats().peak, live + count - 1 );
+    root = TreeNode();
+    const auto released = std::chrono::steady_clock::now();
+    BOOST_CHECK_EQUAL( arena.stats().live, live );
+    std::cout << "Nodes: " << count
+	      << ", expansion: " << std::chrono::duration<double, std::milli>(expanded - start).count() << " ms"
+	      << ", teardown: " << std::chrono::duration<double, std::milli>(released - expanded).count() << " ms\n";
+    arena.printStats(std::cout);
+  }
+  arena.trim();
+  if(live == 0) {
+    BOOST_CHECK_EQUAL( arena.stats().bytes, 0 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(tree_arena_reuse)
+{
+  // Released blocks are merged and split to serve blocks of other sizes
+  auto& arena = NodeArena<TreeNode>::getInstance();
+  uint64_t bytes = 0;
+  for(size_t n = 1; n <= NodeArena<TreeNode>::MAX_BLOCK; ++n) {
+    std::vector<NodeArena<TreeNode>::index_type> blocks;
+    for(size_t total = 0; total < 100000; total += n) {
+      blocks.push_back(arena.allocate(n));
+    }
+    for(auto block : blocks) {
+      arena.release(block, n);
+    }
+    if(n == 1) {
+      bytes = arena.stats().bytes;
+    }
+  }
+  BOOST_CHECK_EQUAL( arena.stats().bytes, bytes );
+}
+
+BOOST_AUTO_TEST_CASE(tree_children_block)
+{
+  // The children are adjacent, in the order of the moves
+  TreeNode root;
+  auto& arena = NodeArena<TreeNode>::getInstance();
+  const auto live = arena.stats().live;
+  const auto moves = root.moves(root.player());
+  const auto children = root.children();
+  BOOST_REQUIRE_EQUAL( children.size(), moves.size() );
+  BOOST_CHECK_EQUAL( arena.stats().live, live + moves.size() );
+  const TreeNode* first = *children.begin();
+  size_t i = 0;
+  for(auto child : children) {
+    BOOST_CHECK_EQUAL( child, first + i );
+    BOOST_CHECK( child->board() == std::get<2>(moves[i]) );
+    ++i;
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_max_nodes, SettingsFixture)
+{
+  // Evicting subtrees bounds the memory, not the value
+  Board::setW(6);
+  Board::setH(6);
+  SimpleStaticEvaluator evaluator;
+  auto& arena = NodeArena<TreeNode>::getInstance();
+  const auto live = arena.stats().live;
+  const int depth = 7;
+  int value[2];
+  uint64_t peak[2];
+  for(size_t max_nodes : {0, 2000}) {
+    TranspositionTable::getInstance().clear();
+    TreeNode::max_nodes = max_nodes;
+    TreeNode::evictions = 0;
+    arena.resetPeak();
+    TreeNode root;
+    root.alphabeta(evaluator, depth, false);
+    value[max_nodes != 0] = root.minMaxVal();
+    peak[max_nodes != 0] = arena.stats().peak - live;
+    std::cout << "Max. nodes: " << max_nodes << ", peak: " << peak[max_nodes != 0]
+	      << ", evictions: " << TreeNode::evictions << "\n";
+  }
+  BOOST_CHECK_EQUAL( value[0], value[1] );
+  // Over budget by at most the children of the searched path
+  BOOST_CHECK( peak[1] <= 2000 + depth * Board::MAX_MOVES );
+  BOOST_CHECK( peak[0] > 2000 + depth * Board::MAX_MOVES );
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_reclaimer, SettingsFixture)
+{
+  // Discarded trees are deleted, in the background or not
+  Board::setW(6);
+  Board::setH(6);
+  auto& arena = NodeArena<TreeNode>::getInstance();
+  auto& reclaimer = Reclaimer::getInstance();
+  const auto live = arena.stats().live;
+  for(bool async : {false, true}) {
+    Reclaimer::async = async;
+    reclaimer.resetStats();
+    TreeNode root;
+    root.nodeCount(7);
+    reclaimer.discard(std::move(root));
+    BOOST_CHECK_EQUAL( root.children().size(), 4 ); // Empty, expanded again
+    root = TreeNode();
+    reclaimer.wait();
+    BOOST_CHECK_EQUAL( arena.stats().live, live );
+    BOOST_CHECK_EQUAL( reclaimer.stats().trees, 1 );
+    reclaimer.printStats(std::cout);
+  }
+}
+
+namespace {
+  /** 
+   * Check the cached leaf state and the children of every node
+   * against the moves of the board.
+   * 
+   * @return Number of passes
+   */
+  int check_mobility(const TreeNode& node)
+  {
+    const Board& b = node.board();
+    const bool moves = b.hasLegalMove(node.player());
+    const bool other = b.hasLegalMove(~node.player());
+    BOOST_CHECK_EQUAL( node.isLeaf(), !moves && !other );
+    BOOST_CHECK_EQUAL( node.children().size(),
+		       moves ? node.moves(node.player()).size() : other ? 1 : 0 );
+    int passes = !moves && other;
+    for(auto child : node.children()) {
+      BOOST_CHECK_EQUAL( child->player(), ~node.player() );
+      passes += check_mobility(*child);
+    }
+    return passes;
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_mobility, SettingsFixture)
+{
+  // Leaves and passes in the complete 4x4 tree
+  Board::setW(4);
+  Board::setH(4);
+  TreeNode root;
+  const int passes = check_mobility(root);
+  std::cout << "Passes in the 4x4 tree: " << passes << "\n";
+  BOOST_CHECK( passes > 0 );
+}
+
+/**
+ * Play random games on an 8x8 board, and count the moves of
+ * getComputerMove() with pruning which are worse than the best
+ * move. The exact values of the position and of the move are found
+ * by a Search without pruning. The board size and the endgame
+ * threshold are left for the SettingsFixture of the test to restore.
+ *
+ * @param depth
+ *
+ * @return The number of worse moves, out of 20 moves in 20 games
+ */
+static int worse_moves(int depth)
+{
+  Board::setW(8);
+  Board::setH(8);
+  TreeNode::endgame_empties = 0;
+  SimpleStaticEvaluator evaluator;
+  const StaticEvaluatorTable evaluatorTab = { &evaluator, &evaluator };
+  Search search(evaluator, false);
+  std::mt19937 gen(7);
+  int worse = 0;
+  for(int game = 0; game < 20; ++game) {
+    TranspositionTable::getInstance().clear();
+    Board board;
+    Board::Player player = Board::BLACK;
+    for(int ply = 0; ply < 20; ++ply) {
+      TreeNode root(player, board);
+      const TreeNode child = root.getComputerMove(evaluatorTab, depth, true);
+      if( search.value(child.board(), child.player(), depth - 1) != search.value(board, player, depth) ) {
+	++worse;
+      }
+      // The next position: a random move
+      auto move_bag = board.moves(player);
+      if( !move_bag.empty() ) {
+	board = std::get<2>(move_bag[gen() % move_bag.size()]);
+      }
+      player = ~player;
+    }
+  }
+  return worse;
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_best_move, SettingsFixture)
+{
+  // The younger children of the root get exact values when they are
+  // as good as the best, so the computer never plays a worse move,
+  // with either backend
+  for(auto backend : {SearchTraits::TREE, SearchTraits::STACK}) {
+    TreeNode::backend = backend;
+    BOOST_CHECK_EQUAL( worse_moves(4), 0 );
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_threads, SettingsFixture)
+{
+  // Searching the root in parallel finds the value of the serial search
+  Board::setW(6);
+  Board::setH(6);
+  SimpleStaticEvaluator evaluator;
+  const StaticEvaluatorTable evaluatorTab = { &evaluator, &evaluator };
+  TreeNode::parallel = SearchTraits::ROOT_SPLIT;
+  for(bool prune : {false, true}) {
+    int value[2];
+    for(int threads : {1, 4}) {
+      TranspositionTable::getInstance().clear();
+      TreeNode::threads = threads;
+      TreeNode root;
+      const TreeNode child = root.getComputerMove(evaluatorTab, 7, prune);
+      value[threads > 1] = root.minMaxVal();
+      BOOST_CHECK_EQUAL( int(child.minMaxVal()), int(root.minMaxVal()) );
+    }
+    BOOST_CHECK_EQUAL( value[0], value[1] );
+  }
+  // The moves are as good as those of the serial search
+  BOOST_CHECK_EQUAL( worse_moves(4), 0 );
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_ybwc, SettingsFixture)
+{
+  // Splitting nodes between threads finds the value of the serial search
+  Board::setW(6);
+  Board::setH(6);
+  SimpleStaticEvaluator evaluator;
+  const StaticEvaluatorTable evaluatorTab = { &evaluator, &evaluator };
+  TreeNode::parallel = SearchTraits::YBWC;
+  for(bool prune : {false, true}) {
+    int value[2];
+    for(int threads : {1, 4}) {
+      TranspositionTable::getInstance().clear();
+      TreeNode::threads = threads;
+      TreeNode::splits = 0;
+      TreeNode root;
+      const TreeNode child = root.getComputerMove(evaluatorTab, 8, prune);
+      value[threads > 1] = root.minMaxVal();
+      BOOST_CHECK_EQUAL( int(child.minMaxVal()), int(root.minMaxVal()) );
+      std::cout << "Pruning: " << prune << ", threads: " << threads
+		<< ", splits: " << TreeNode::splits << "\n";
+      BOOST_CHECK_EQUAL( TreeNode::splits > 0, threads > 1 );
+    }
+    BOOST_CHECK_EQUAL( value[0], value[1] );
+  }
+  // The root is split too, and the moves are as good as those of the
+  // serial search
+  TreeNode::splits = 0;
+  BOOST_CHECK_EQUAL( worse_moves(4), 0 );
+  BOOST_CHECK( TreeNode::splits > 0 );
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_lazy_smp, SettingsFixture)
+{
+  // Helper threads sharing the transposition table do not change the value
+  Board::setW(6);
+  Board::setH(6);
+  SimpleStaticEvaluator evaluator;
+  const StaticEvaluatorTable evaluatorTab = { &evaluator, &evaluator };
+  TreeNode::parallel = SearchTraits::LAZY_SMP;
+  for(bool prune : {false, true}) {
+    int value[2];
+    for(int threads : {1, 4}) {
+      TranspositionTable::getInstance().clear();
+      TreeNode::threads = threads;
+      TreeNode root;
+      const TreeNode child = root.getComputerMove(evaluatorTab, 8, prune);
+      value[threads > 1] = root.minMaxVal();
+      BOOST_CHECK_EQUAL( int(child.minMaxVal()), int(root.minMaxVal()) );
+    }
+    BOOST_CHECK_EQUAL( value[0], value[1] );
+  }
+  // The moves are as good as those of the serial search
+  BOOST_CHECK_EQUAL( worse_moves(4), 0 );
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_pvs, SettingsFixture)
+{
+  // PVS finds the value of alpha-beta, usually searching fewer nodes
+  Board::setW(8);
+  Board::setH(8);
+  SimpleStaticEvaluator evaluator;
+  const StaticEvaluatorTable evaluatorTab = { &evaluator, &evaluator };
+  Board board;
+  BoardTraits::Player player = Board::BLACK;
+  uint64_t total[2] = { 0, 0 };
+  for(int position = 0; position < 6; ++position) {
+    int value[2];
+    uint64_t nodes[2];
+    for(auto algorithm : {SearchTraits::ALPHABETA, SearchTraits::PVS}) {
+      TranspositionTable::getInstance().clear();
+      MoveOrdering::getInstance().clear();
+      TreeNode::algorithm = algorithm;
+      TreeNode::nodes = 0;
+      TreeNode root(player, board);
+      const TreeNode child = root.getComputerMove(evaluatorTab, 8, true);
+      value[algorithm] = root.minMaxVal();
+      nodes[algorithm] = TreeNode::nodes;
+      total[algorithm] += nodes[algorithm];
+      BOOST_CHECK_EQUAL( int(child.minMaxVal()), int(root.minMaxVal()) );
+    }
+    std::cout << "Position: " << position << ", alpha-beta nodes: " << nodes[SearchTraits::ALPHABETA]
+	      << ", PVS nodes: " << nodes[SearchTraits::PVS] << "\n";
+    BOOST_CHECK_EQUAL( value[SearchTraits::ALPHABETA], value[SearchTraits::PVS] );
+    // The next position: three more moves
+    for(int k = 0; k < 3; ++k) {
+      const uint64_t legal = board.legalMoves(player);
+      if(legal != 0) {
+	board.play(player, Board::bitscan(legal));
+      }
+      player = ~player;
+    }
+  }
+  std::cout << "Total alpha-beta nodes: " << total[SearchTraits::ALPHABETA]
+	    << ", PVS nodes: " << total[SearchTraits::PVS] << "\n";
+  // The null windows and the aspiration window only give bounds to
+  // children worse than the best one
+  TreeNode::algorithm = SearchTraits::PVS;
+  BOOST_CHECK_EQUAL( worse_moves(4), 0 );
+  TreeNode::algorithm = SearchTraits::MTDF;
+  BOOST_CHECK_EQUAL( worse_moves(4), 0 );
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_mtdf, SettingsFixture)
+{
+  // MTD(f) finds the value of alpha-beta
+  Board::setW(8);
+  Board::setH(8);
+  SimpleStaticEvaluator evaluator;
+  const StaticEvaluatorTable evaluatorTab = { &evaluator, &evaluator };
+  Board board;
+  BoardTraits::Player player = Board::BLACK;
+  uint64_t total[3] = { 0, 0, 0 };
+  for(int position = 0; position < 6; ++position) {
+    int value[3];
+    uint64_t nodes[3];
+    for(auto algorithm : {SearchTraits::ALPHABETA, SearchTraits::MTDF}) {
+      TranspositionTable::getInstance().clear();
+      MoveOrdering::getInstance().clear();
+      TreeNode::algorithm = algorithm;
+      TreeNode::nodes = 0;
+      TreeNode root(player, board);
+      const TreeNode child = root.getComputerMove(evaluatorTab, 8, true);
+      value[algorithm] = root.minMaxVal();
+      nodes[algorithm] = TreeNode::nodes;
+      total[algorithm] += nodes[algorithm];
+      BOOST_CHECK_EQUAL( int(child.minMaxVal()), int(root.minMaxVal()) );
+    }
+    std::cout << "Position: " << position << ", alpha-beta nodes: " << nodes[SearchTraits::ALPHABETA]
+	      << ", MTD(f) nodes: " << nodes[SearchTraits::MTDF] << "\n";
+    BOOST_CHECK_EQUAL( value[SearchTraits::ALPHABETA], value[SearchTraits::MTDF] );
+    // The next position: three more moves
+    for(int k = 0; k < 3; ++k) {
+      const uint64_t legal = board.legalMoves(player);
+      if(legal != 0) {
+	board.play(player, Board::bitscan(legal));
+      }
+      player = ~player;
+    }
+  }
+  std::cout << "Total alpha-beta nodes: " << total[SearchTraits::ALPHABETA]
+	    << ", MTD(f) nodes: " << total[SearchTraits::MTDF] << "\n";
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_wld, SettingsFixture)
+{
+  // Windows around 0 find the outcome of minmax, with fewer nodes
+  TreeNode::endgame_empties = 0;
+  Board::setW(4);
+  Board::setH(4);
+  SimpleStaticEvaluator evaluator;
+  const StaticEvaluatorTable evaluatorTab = { &evaluator, &evaluator };
+  EndgameSolver solver;
+  auto sign = [](int val) { return ( val > 0 ) - ( val < 0 ); };
+  for(auto backend : {SearchTraits::TREE, SearchTraits::STACK}) {
+    TreeNode::backend = backend;
+    Board board;
+    BoardTraits::Player player = Board::BLACK;
+    for(int position = 0; position < 4; ++position) {
+      const int outcome = sign(solver.value(board, player));
+      uint64_t nodes[2];
+      for(bool wld : {false, true}) {
+	TranspositionTable::getInstance().clear();
+	TreeNode::wld = wld;
+	TreeNode::nodes = 0;
+	TreeNode root(player, board);
+	const TreeNode child = root.getComputerMove(evaluatorTab, 128, false);
+	nodes[wld] = TreeNode::nodes;
+	// The move keeps the outcome
+	BOOST_CHECK_EQUAL( sign(solver.value(child.board(), child.player())), outcome );
+	if(wld) {
+	  BOOST_CHECK_EQUAL( int(root.minMaxVal()), outcome );
+	  BOOST_CHECK_EQUAL( int(child.minMaxVal()), outcome );
+	}
+      }
+      if(backend == SearchTraits::STACK) {	// minmax() counts no nodes
+	std::cout << "Position: " << position << ", outcome: " << outcome
+		  << ", minmax nodes: " << nodes[false] << ", WLD nodes: " << nodes[true] << "\n";
+	BOOST_CHECK( nodes[true] < nodes[false] );
+      }
+      // The next position: two more moves
+      for(int k = 0; k < 2; ++k) {
+	const uint64_t legal = board.legalMoves(player);
+	if(legal != 0) {
+	  board.play(player, Board::bitscan(legal));
+	}
+	player = ~player;
+      }
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(tree_wld_move_time, SettingsFixture)
+{
+  // With a time budget, the outcome is solved by the last iteration, if
+  // it completes
+  TreeNode::endgame_empties = 0;
+  TreeNode::wld = true;
+  TreeNode::move_time_ms = 10000;
+  SimpleStaticEvaluator evaluator;
+  const StaticEvaluatorTable evaluatorTab = { &evaluator, &evaluator };
+  Board::setW(4);
+  Board::setH(4);
+  TranspositionTable::getInstance().clear();
+  EndgameSolver solver;
+  auto sign = [](int val) { return ( val > 0 ) - ( val < 0 ); };
+  TreeNode root;
+  const TreeNode child = root.getComputerMove(evaluatorTab, 128, false);
+  BOOST_CHECK( TreeNode::solved );
+  BOOST_CHECK_EQUAL( TreeNode::search_depth, 128 );
+  BOOST_CHECK_EQUAL( int(root.minMaxVal()), sign(solver.value(Board(), Board::BLACK)) );
+  BOOST_CHECK_EQUAL( sign(solver.value(child.board(), child.player())), int(root.minMaxVal()) );
+
+  // Out of time, a shallower iteration chooses the move
+  Board::setW(8);
+  Board::setH(8);
+  TreeNode::move_time_ms = 100;
+  TreeNode root8;
+  root8.getComputerMove(evaluatorTab, 128, false);
+  BOOST_CHECK( !TreeNode::solved );
+  BOOST_CHECK( TreeNode::search_depth < 128 );
+}